@@ -0,0 +1,1051 @@
+/**
+* Implementation of Itti's model
+*
+* 	- Image channels created from input (r_i, g_i, b_i):
+* 		1. Intensity = (r_i + g_i + b_i)/3
+* 		2. Blue      = b - (r+g)/2,              b = b_i / i , same for r and g
+* 		3. Red       = r - (b+g)/2
+* 		4. Green     = g - (r+b)/2
+* 		5. Yellow    = (r+g)/2 - |r-g|/2 - b
+*
+* 	- Image scales needed (i = 2-8, where scale i connotates a ratio of 1:i)
+* 	- Coarser scales are obtained through a low-pass filtering and subsampling
+* 		= NTS: use a basic low-pass filter and subsample
+*
+* 	- Orientation filters are obtained using Gabor filter
+* 		= Not sure about gabor filter parameters
+*
+*	- Normalziation is performed
+*		= Normalizes maps with (M - m)^2
+*		     * [M is global maxima, and m is mean of all maxima]
+*		= After normalization, conspicuity maps are multiplied by the learned
+*		  weights for the object being searched for.
+*
+*	** Points to note:
+*	- focus now on producing a prototype with very little regard for efficiency
+*	- try to modularize as much as possible to allow for simple enhancements
+*	- All the normalization makes it hard to compare across images; an object
+*	  with low saliency in a bland image with have the same saliency as a highly
+*	  salient object in a very exciting image.
+*
+* 	To do:
+* 		- Consider memory allocation issues if this is to be implemented
+*/
+
+#include "attention.h"
+#include "util.h"
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+
+/**
+ * Calculates the integrated conspicuity maps of intensity, opponency and
+ * orientation (workspace.intens_CM, opp_CM and ori_CM, not normalized yet)
+ * from the channels in workspace.channels.
+ *
+ * The normalized conspicuity pyramids of all channels are computed in
+ * parallel (see conspicuity_pyramids) and then integrated. With
+ * options.lowMemory the channels are processed one at a time instead and
+ * folded into the integrated maps as they are done (see
+ * streaming_conspicuity_maps); the per-channel pyramids are not shown in
+ * debug mode then.
+ *
+ * @param input           input image (for debug display)
+ * @param workspace       pipeline buffers
+ * @param orientationMaps output, the 0, 45, 90 and 135 degree orientation maps
+ *                        (NULL if not needed)
+ * @param debug           if set to true, show images produced at each stage
+ * @param options         pipeline options
+ */
+static void integrated_conspicuity_maps(Mat& input, SaliencyWorkspace& workspace, Mat* orientationMaps,
+                                        bool debug, const SaliencyOptions& options)
+{
+    Mat* channels = workspace.channels;
+
+    if (options.lowMemory)
+    {
+        streaming_conspicuity_maps(channels, workspace.intens_CM, workspace.opp_CM,
+                                   workspace.ori_CM, orientationMaps, options);
+        return;
+    }
+
+    // The orientation maps are computed on the full resolution intensity or
+    // on the levels of the intensity pyramid (options.orientationOnPyramid)
+    int numOrient = options.numOrientations;
+    int numMaps = SaliencyScales::numMaps;
+    conspicuity_pyramids(workspace, options);
+
+    vector<Mat>& orientations = workspace.orientations;
+    vector<Mat>& or_cm = workspace.or_cm;
+    Mat* oppRG_cm = workspace.oppRG_cm;
+    Mat* oppBY_cm = workspace.oppBY_cm;
+    Mat* intens_cm = workspace.intens_cm;
+
+    for (int i = 0; orientationMaps && i < 4; ++i)
+    {
+        orientationMaps[i] = orientations[i*numOrient/4];
+    }
+
+    if (debug)
+    {
+        my_imshow("input    ", input                        , 50  , 50);
+        my_imshow("Intensity", channels[4]                  , 50  , 400);
+        my_imshow("Channel 1", orientations[0]              , 600 , 50);
+        my_imshow("Channel 2", orientations[numOrient/4]    , 600 , 400);
+        my_imshow("Channel 3", orientations[numOrient/2]    , 1150, 50);
+        my_imshow("Channel 4", orientations[3*numOrient/4]  , 1150, 400);
+        waitKey(100000);
+
+        debug_show_imgPyramid(oppRG_cm, "RG Opponency");
+        debug_show_imgPyramid(oppBY_cm, "BY Opponency");
+        debug_show_imgPyramid(intens_cm, "Intensity");
+        debug_show_imgPyramid(&or_cm[0],                         "Orientation 0");
+        debug_show_imgPyramid(&or_cm[numMaps*(numOrient/4)],     "Orientation 45");
+        debug_show_imgPyramid(&or_cm[numMaps*(numOrient/2)],     "Orientation 90");
+        debug_show_imgPyramid(&or_cm[numMaps*(3*numOrient/4)],   "Orientation 135");
+    }
+
+    //integrate conspicuity maps (into workspace buffers sized by the
+    //integration, all the size of the conspicuity maps)
+    integrate_single_pyramid(intens_cm, workspace.intens_CM, numMaps);
+    integrate_color_pyamids(oppBY_cm, oppRG_cm, workspace.opp_CM, numMaps);
+    integrate_orient_pyamids(&or_cm[0], numOrient, workspace.ori_CM, numMaps, &workspace.orScratch);
+}
+
+/**
+ * Base maps of the spectral backend (SaliencyOptions::backend), at the size
+ * of the spectral working image: the spectral residual maps of intensity
+ * (0), of both opponencies (2, the sum of red-green and blue-yellow) and of
+ * red, green, blue and yellow (3-6), each normalized like the conspicuity
+ * maps, so the learned weights of these channels apply as they are. The
+ * backend has no orientation features: maps 1 and 7-10 are zero and the
+ * orientation weights have no effect.
+ *
+ * @param input     input image
+ * @param baseMaps  output, the 11 base maps
+ * @param workspace pipeline buffers
+ */
+static void spectral_base_maps(Mat& input, BaseMaps& baseMaps, SaliencyWorkspace& workspace)
+{
+    Mat* channels = workspace.channels;
+    Mat* maps = workspace.resized;
+    Mat* buffers = workspace.spectralBuffers;
+
+    resize(input, workspace.spectralInput, spectral_size(input.size()), 0, 0, INTER_AREA);
+    split_rgbyi(workspace.spectralInput, channels);
+
+    spectral_residual(channels[4], maps[0], buffers);
+    normalize(maps[0]);
+    for (int i = 0; i < 4; ++i)
+    {
+        spectral_residual(channels[i], maps[3 + i], buffers);
+        normalize(maps[3 + i]);
+    }
+
+    // red-green into maps[2], blue-yellow into maps[1] for the sum
+    subtract(channels[0], channels[1], workspace.opponency);
+    spectral_residual(workspace.opponency, maps[2], buffers);
+    normalize(maps[2]);
+    subtract(channels[2], channels[3], workspace.opponency);
+    spectral_residual(workspace.opponency, maps[1], buffers);
+    normalize(maps[1]);
+    add(maps[2], maps[1], maps[2]);
+    normalize(maps[2]);
+
+    maps[1].setTo(Scalar::all(0));
+
+    for (int i = 0; i < 7; ++i)
+    {
+        baseMaps.maps[i] = maps[i];
+    }
+    for (int i = 7; i < NUM_BASE_MAPS; ++i)
+    {
+        baseMaps.maps[i] = maps[1];
+    }
+}
+
+/**
+ * The part of the Itti pipeline shared by every base map: the channels of
+ * the input downsampled to options.startScale (workspace.channels) and the
+ * normalized integrated conspicuity maps (workspace.intens_CM, ori_CM and
+ * opp_CM, at the size of the conspicuity maps).
+ *
+ * @param  input           input image
+ * @param  workspace       pipeline buffers
+ * @param  orientationMaps output, the 0, 45, 90 and 135 degree orientation
+ *                         maps, not normalized
+ * @param  debug           if set to true, show images produced at each stage
+ * @param  options         pipeline options
+ * @return                 size of the working image (of the channels)
+ */
+static Size conspicuity_base_maps(Mat& input, SaliencyWorkspace& workspace, Mat* orientationMaps, bool debug,
+                                  const SaliencyOptions& options)
+{
+    Mat* channels = workspace.channels;
+
+    // work on the input downsampled to pyramid level options.startScale (the
+    // input itself at full resolution)
+    Mat scaled;
+    downsample_input(input, scaled, options.startScale, workspace.downsampled, options.resampling);
+
+    //extract colors and intensity.
+    //Channels in order: Red, Green, Blue, Yellow, Intensity
+    split_rgbyi(scaled, channels);
+
+    if (debug)
+    {
+        cout << "Debug computeBaseMaps 1: show raw channels" << endl;
+        my_imshow("input    ",  input      , 50  , 50);
+        my_imshow("Red",        channels[0], 50  , 400);
+        my_imshow("Green",      channels[1], 600 , 50);
+        my_imshow("Blue",       channels[2], 600 , 400);
+        my_imshow("Yellow",     channels[3], 1150, 50);
+        my_imshow("Intensity",  channels[4], 1150, 400);
+        waitKey(100000);
+    }
+
+    // Calculate the integrated conspicuity maps of intensity, opponency and
+    // orientation, and the 0, 45, 90 and 135 degree orientation maps
+    integrated_conspicuity_maps(input, workspace, orientationMaps, debug, options);
+
+    // normalize again ?!
+    normalize(workspace.intens_CM);
+    normalize(workspace.ori_CM);
+    normalize(workspace.opp_CM);
+
+    return scaled.size();
+}
+
+/**
+ * Computes the normalized base maps of an image (see BaseMaps), the common
+ * part of every pipeline below; object specific maps and feature vectors are
+ * then cheap operations on them.
+ *
+ * @param input     input image
+ * @param baseMaps  output, the 11 base maps at the size of the working image
+ *                  (of the conspicuity maps with options.coarseMaps)
+ * @param debug     if set to true, show images produced at each stage
+ * @param options   pipeline options
+ */
+void computeBaseMaps(Mat& input, BaseMaps& baseMaps, bool debug, const SaliencyOptions& options)
+{
+    SaliencyWorkspace workspace;
+    computeBaseMaps(input, baseMaps, debug, options, workspace);
+}
+
+/**
+ * computeBaseMaps with caller-owned buffers: after the first call for a frame
+ * size nothing is allocated (outside lowMemory mode, see SaliencyWorkspace).
+ * The base maps point into the workspace and are overwritten by the next
+ * call.
+ */
+void computeBaseMaps(Mat& input, BaseMaps& baseMaps, bool debug, const SaliencyOptions& options,
+                     SaliencyWorkspace& workspace)
+{
+    if (options.backend == BACKEND_SPECTRAL)
+    {
+        spectral_base_maps(input, baseMaps, workspace);
+        return;
+    }
+
+    Mat* channels = workspace.channels;
+    Mat orientationMaps[4];
+    Size workingSize = conspicuity_base_maps(input, workspace, orientationMaps, debug, options);
+
+    Mat& intens_CM = workspace.intens_CM;
+    Mat& opp_CM = workspace.opp_CM;
+    Mat& ori_CM = workspace.ori_CM;
+
+    //normalize all feature maps .. hues are already normalized, normalize orientation
+    for (int i = 0; i < 4; ++i)
+    {
+        normalize(orientationMaps[i]);
+    }
+
+    Mat* resized = workspace.resized;
+    if (options.coarseMaps)
+    {
+        // everything down to the size of the conspicuity maps (area
+        // averaging), which are used as they are
+        Size mapSize = intens_CM.size();
+        baseMaps.maps[0] = intens_CM;
+        baseMaps.maps[1] = ori_CM;
+        baseMaps.maps[2] = opp_CM;
+        for (int i = 0; i < 4; ++i)
+        {
+            resize(channels[i], resized[7 + i], mapSize, 0, 0, INTER_AREA);
+            resize(orientationMaps[i], resized[3 + i], mapSize, 0, 0, INTER_AREA);
+            baseMaps.maps[3 + i] = resized[7 + i];
+            baseMaps.maps[7 + i] = resized[3 + i];
+        }
+        return;
+    }
+
+    //resize all maps (into workspace buffers, the conspicuity maps keep
+    //their size for the next frame)
+    resize(intens_CM, resized[0], workingSize);
+    resize(ori_CM, resized[1], workingSize);
+    resize(opp_CM, resized[2], workingSize);
+
+    // orientation maps are at pyramid level cL when computed on the pyramid
+    for (int i = 0; i < 4; ++i)
+    {
+        if (orientationMaps[i].size() != workingSize)
+        {
+            resize(orientationMaps[i], resized[3 + i], workingSize);
+            orientationMaps[i] = resized[3 + i];
+        }
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        baseMaps.maps[i] = resized[i];
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        baseMaps.maps[3 + i] = channels[i];
+        baseMaps.maps[7 + i] = orientationMaps[i];
+    }
+}
+
+/**
+ * Object specific saliency map from the base maps, normalized to [0, 1].
+ *
+ * @param baseMaps       base maps of the image (see computeBaseMaps)
+ * @param objectFeatures feature weights, in the order of the base maps
+ * @param numMaps        number of base maps used (the first numMaps)
+ * @param avgGlobal      true if maps are average, false for winner-take-all
+ * @param output         output map (CV_32F, size of the base maps)
+ */
+void combineBaseMaps(const BaseMaps& baseMaps, const float* objectFeatures, int numMaps, bool avgGlobal,
+                     Mat& output)
+{
+    const Mat* maps[NUM_BASE_MAPS];
+    for (int i = 0; i < numMaps; ++i)
+    {
+        maps[i] = &baseMaps.maps[i];
+    }
+
+    //integrate all maps, multiplied by the feature weights, in one pass
+    if (avgGlobal)
+    {
+        weighted_sum_maps(maps, objectFeatures, numMaps, output);
+    } else {
+        max_weighted_maps(maps, objectFeatures, numMaps, output);
+    }
+
+    // Normalize final output ?
+    normalize(output, output, 0.0, 1.0, NORM_MINMAX, CV_32F);
+}
+
+/**
+ * Object specific saliency maps of several objects from the same base maps
+ * (the average combination of combineBaseMaps, one map per weight vector),
+ * computed together with a single pass over the base maps.
+ *
+ * @param baseMaps       base maps of the image (see computeBaseMaps)
+ * @param objectFeatures numObjects feature vectors of NUM_BASE_MAPS weights
+ * @param numObjects     number of objects
+ * @param outputs        output, numObjects maps normalized to [0, 1]
+ */
+void combineBaseMapsBatch(const BaseMaps& baseMaps, float** objectFeatures, int numObjects, Mat* outputs)
+{
+    const Mat* maps[NUM_BASE_MAPS];
+    for (int i = 0; i < NUM_BASE_MAPS; ++i)
+    {
+        maps[i] = &baseMaps.maps[i];
+    }
+
+    vector<float> weights(numObjects * NUM_BASE_MAPS);
+    for (int k = 0; k < numObjects; ++k)
+    {
+        std::copy(objectFeatures[k], objectFeatures[k] + NUM_BASE_MAPS, &weights[k * NUM_BASE_MAPS]);
+    }
+
+    weighted_sum_maps_batch(maps, &weights[0], NUM_BASE_MAPS, numObjects, outputs);
+
+    for (int k = 0; k < numObjects; ++k)
+    {
+        normalize(outputs[k], outputs[k], 0.0, 1.0, NORM_MINMAX, CV_32F);
+    }
+}
+
+/**
+ * Normalizes each group of a feature vector (conspicuity, color and
+ * orientation maps) to sum to 1 in absolute value; groups that are all 0
+ * stay 0.
+ *
+ * @param featureVec NUM_BASE_MAPS features, normalized in place
+ */
+static void normalize_feature_groups(float* featureVec)
+{
+    float sumFeat1,sumFeat2,sumFeat3;
+    sumFeat1 = abs(featureVec[0]) + abs(featureVec[1]) + abs(featureVec[2]);
+    sumFeat2 = abs(featureVec[3]) + abs(featureVec[4]) + abs(featureVec[5]) + abs(featureVec[6]);
+    sumFeat3 = abs(featureVec[7]) + abs(featureVec[8]) + abs(featureVec[9]) + abs(featureVec[10]);
+
+    if(sumFeat1 != 0){
+        featureVec[0] = featureVec[0]/sumFeat1;
+        featureVec[1] = featureVec[1]/sumFeat1;
+        featureVec[2] = featureVec[2]/sumFeat1;
+    }
+
+    if(sumFeat2 != 0){
+        featureVec[3] = featureVec[3]/sumFeat2;
+        featureVec[4] = featureVec[4]/sumFeat2;
+        featureVec[5] = featureVec[5]/sumFeat2;
+        featureVec[6] = featureVec[6]/sumFeat2;
+
+    }
+
+    if(sumFeat3 != 0){
+
+        featureVec[7] = featureVec[7]/sumFeat3;
+        featureVec[8] = featureVec[8]/sumFeat3;
+        featureVec[9] = featureVec[9]/sumFeat3;
+        featureVec[10] = featureVec[10]/sumFeat3;
+    }
+}
+
+/**
+ * Saliency feature vector of an image: the means of its base maps, each
+ * group (conspicuity, color and orientation maps) normalized to sum to 1.
+ *
+ * @param  baseMaps base maps of the image (see computeBaseMaps)
+ * @return          NUM_BASE_MAPS features (allocated, owned by the caller)
+ */
+float* baseMapFeatures(const BaseMaps& baseMaps)
+{
+    double features[NUM_BASE_MAPS];
+    float* featureVec = new float[NUM_BASE_MAPS];
+
+    const Mat* maps[NUM_BASE_MAPS];
+    for (int i = 0; i < NUM_BASE_MAPS; ++i)
+    {
+        maps[i] = &baseMaps.maps[i];
+    }
+    mean_maps(maps, NUM_BASE_MAPS, features);
+
+    for(int i = 0; i < NUM_BASE_MAPS; i++)
+    {
+        featureVec[i] = (float) features[i];
+    }
+    normalize_feature_groups(featureVec);
+
+    return featureVec;
+}
+
+/**
+ * Feature vectors of proposals, the per-box form of baseMapFeatures: the
+ * means of the 11 base maps inside every box and in its surround ring, each
+ * normalized like baseMapFeatures so they compare with the learned vectors
+ * (learnFeaturefromDataset). All maps share one interleaved summed-area
+ * table, built once, so a box costs the same whatever its size.
+ *
+ * @param baseMaps     base maps of the image (see computeBaseMaps)
+ * @param imageSize    size of the image the proposals are in
+ * @param objProps     proposals
+ * @param numProposals number of proposals
+ * @param inside       output, numProposals x NUM_BASE_MAPS features inside
+ *                     the boxes (row-major)
+ * @param surround     output, numProposals x NUM_BASE_MAPS features of the
+ *                     surround rings, NULL if not needed
+ */
+void baseMapProposalFeatures(const BaseMaps& baseMaps, Size imageSize, proposal* objProps, int numProposals,
+                             float* inside, float* surround)
+{
+    const Mat* maps[NUM_BASE_MAPS];
+    for (int i = 0; i < NUM_BASE_MAPS; ++i)
+    {
+        maps[i] = &baseMaps.maps[i];
+    }
+
+    Mat table;
+    multiChannelIntegral(maps, NUM_BASE_MAPS, table);
+
+    double in[NUM_BASE_MAPS], ring[NUM_BASE_MAPS];
+    for (int p = 0; p < numProposals; ++p)
+    {
+        boxMeans(table, imageSize, objProps[p], in, ring);
+
+        float* inVec = inside + p * NUM_BASE_MAPS;
+        for (int i = 0; i < NUM_BASE_MAPS; ++i)
+        {
+            inVec[i] = (float) in[i];
+        }
+        normalize_feature_groups(inVec);
+
+        if (surround)
+        {
+            float* ringVec = surround + p * NUM_BASE_MAPS;
+            for (int i = 0; i < NUM_BASE_MAPS; ++i)
+            {
+                ringVec[i] = (float) ring[i];
+            }
+            normalize_feature_groups(ringVec);
+        }
+    }
+}
+
+/**
+ * Options of the proposal paths below: their base maps always stay at the
+ * size of the conspicuity maps (coarseMaps), as the proposals are mapped
+ * onto the maps at their own scale anyway, so no full resolution plane is
+ * built for them.
+ */
+static SaliencyOptions proposal_options(const SaliencyOptions& options)
+{
+    SaliencyOptions proposalOptions = options;
+    proposalOptions.coarseMaps = true;
+    return proposalOptions;
+}
+
+/**
+ * baseMapProposalFeatures from an image: computes its base maps first, at
+ * the size of the conspicuity maps (see proposal_options).
+ *
+ * @param image        input image
+ * @param objProps     proposals
+ * @param numProposals number of proposals
+ * @param inside       output, numProposals x NUM_BASE_MAPS features inside
+ *                     the boxes (row-major)
+ * @param surround     output, the same for the surround rings, NULL if not
+ *                     needed
+ * @param options      pipeline options
+ */
+void proposalFeatures(Mat& image, proposal* objProps, int numProposals, float* inside, float* surround,
+                      const SaliencyOptions& options)
+{
+    SaliencyWorkspace workspace;
+    proposalFeatures(image, objProps, numProposals, inside, surround, options, workspace);
+}
+
+/**
+ * proposalFeatures with caller-owned pipeline buffers (see SaliencyWorkspace).
+ */
+void proposalFeatures(Mat& image, proposal* objProps, int numProposals, float* inside, float* surround,
+                      const SaliencyOptions& options, SaliencyWorkspace& workspace)
+{
+    BaseMaps baseMaps;
+    computeBaseMaps(image, baseMaps, false, proposal_options(options), workspace);
+    baseMapProposalFeatures(baseMaps, image.size(), objProps, numProposals, inside, surround);
+}
+
+/**
+ * Weighted sum of maps of different sizes at one size: the maps of the output
+ * size are summed into the output, the maps of each other size are summed at
+ * that size and every partial sum is resized once (bilinear) and added,
+ * instead of resizing every map. The resize is linear, so this is the sum of
+ * the resized maps up to float rounding. Partial sum g (in the order of the
+ * first map of each size) goes to scratch[2g] and is resized into scratch[1],
+ * so with the same options every buffer keeps its size from frame to frame.
+ *
+ * @param maps    numMaps maps (CV_32F)
+ * @param weights numMaps weights
+ * @param numMaps number of maps (at most NUM_BASE_MAPS)
+ * @param size    size of the output
+ * @param output  output map (CV_32F)
+ * @param scratch buffers, 2 per size other than the output size
+ */
+static void weighted_sum_resized(const Mat* const* maps, const float* weights, int numMaps, Size size,
+                                 Mat& output, Mat* scratch)
+{
+    CV_Assert(numMaps <= NUM_BASE_MAPS);
+    const Mat* group[NUM_BASE_MAPS];
+    float groupWeights[NUM_BASE_MAPS];
+    bool written = false;
+
+    // the maps of the output size, straight into the output
+    int n = 0;
+    for (int i = 0; i < numMaps; ++i)
+    {
+        if (maps[i]->size() == size)
+        {
+            group[n] = maps[i];
+            groupWeights[n++] = weights[i];
+        }
+    }
+    if (n > 0)
+    {
+        weighted_sum_maps(group, groupWeights, n, output);
+        written = true;
+    }
+
+    bool done[NUM_BASE_MAPS] = {false};
+    int numGroups = 0;
+    for (int i = 0; i < numMaps; ++i)
+    {
+        if (done[i] || maps[i]->size() == size)
+        {
+            continue;
+        }
+
+        // the maps of the size of map i
+        n = 0;
+        for (int j = i; j < numMaps; ++j)
+        {
+            if (!done[j] && maps[j]->size() == maps[i]->size())
+            {
+                group[n] = maps[j];
+                groupWeights[n++] = weights[j];
+                done[j] = true;
+            }
+        }
+
+        Mat& partial = scratch[2 * numGroups++];
+        weighted_sum_maps(group, groupWeights, n, partial);
+        if (written)
+        {
+            resize(partial, scratch[1], size);
+            add(output, scratch[1], output);
+        } else {
+            resize(partial, output, size);
+            written = true;
+        }
+    }
+}
+
+/**
+ * Object specific saliency map at the size of the working image from the
+ * first numMaps base maps, into workspace.global_CM, without computing the
+ * base maps it does not need: the conspicuity maps are combined at their own
+ * size and only the combination is resized (see weighted_sum_resized), and
+ * the orientation maps are only normalized when they are used. The
+ * winner-take-all combination only takes the conspicuity maps (numMaps 3),
+ * whose maximum is taken at their size. The spectral backend and coarseMaps
+ * combine computeBaseMaps as they are.
+ *
+ * @param input     input image
+ * @param features  feature weights, in the order of the base maps
+ * @param numMaps   number of base maps used (the first numMaps)
+ * @param avgGlobal true if maps are average, false for winner-take-all
+ * @param debug     if set to true, show images produced at each stage
+ * @param options   pipeline options
+ * @param workspace pipeline buffers
+ */
+static void combined_saliency_map(Mat& input, const float* features, int numMaps, bool avgGlobal, bool debug,
+                                  const SaliencyOptions& options, SaliencyWorkspace& workspace)
+{
+    Mat& output = workspace.global_CM;
+    if (options.backend == BACKEND_SPECTRAL || options.coarseMaps)
+    {
+        BaseMaps baseMaps;
+        computeBaseMaps(input, baseMaps, debug, options, workspace);
+        combineBaseMaps(baseMaps, features, numMaps, avgGlobal, output);
+        return;
+    }
+    CV_Assert(avgGlobal || numMaps <= 3);
+
+    Mat orientationMaps[4];
+    Size workingSize = conspicuity_base_maps(input, workspace, orientationMaps, debug, options);
+
+    const Mat* maps[NUM_BASE_MAPS] = {&workspace.intens_CM, &workspace.ori_CM, &workspace.opp_CM};
+    for (int i = 0; i < 4; ++i)
+    {
+        maps[3 + i] = &workspace.channels[i];
+        maps[7 + i] = &orientationMaps[i];
+    }
+    for (int i = 7; i < numMaps; ++i)
+    {
+        normalize(orientationMaps[i - 7]);
+    }
+
+    if (avgGlobal)
+    {
+        weighted_sum_resized(maps, features, numMaps, workingSize, output, workspace.resized);
+    } else {
+        max_weighted_maps(maps, features, numMaps, workspace.resized[0]);
+        resize(workspace.resized[0], output, workingSize);
+    }
+
+    // Normalize final output ?
+    normalize(output, output, 0.0, 1.0, NORM_MINMAX, CV_32F);
+}
+
+/**
+ * Initial attempt at outputing normalized saliency maps
+ *
+ * @param  image          input image
+ * @param  objectFeatures float-array determining the feature weights
+ * @param  avgGlobal      true if maps are average, false for winner-take-all
+ * @param  debug          if set to true, show images produced at each stage
+ * @return                an object-specific saliency map
+ */
+Mat generateSaliency(Mat input, float* objectFeatures, bool avgGlobal, bool debug, const SaliencyOptions& options)
+{
+    SaliencyWorkspace workspace;
+    return generateSaliency(input, objectFeatures, avgGlobal, debug, options, workspace);
+}
+
+/**
+ * generateSaliency with caller-owned buffers: after the first call for a
+ * frame size nothing is allocated (outside lowMemory mode, see
+ * SaliencyWorkspace). The returned map points into the workspace and is
+ * overwritten by the next call.
+ */
+Mat generateSaliency(Mat input, float* objectFeatures, bool avgGlobal, bool debug, const SaliencyOptions& options,
+                     SaliencyWorkspace& workspace)
+{
+    // get time (to be used for calculating time for saliency generation)
+    double t = (double)getTickCount();
+
+    // only the conspicuity maps (intensity, orientation, opponency)
+    combined_saliency_map(input, objectFeatures, 3, avgGlobal, debug, options, workspace);
+
+    t = ((double)getTickCount() - t)/getTickFrequency();
+    cout << "Total so far (without read and write) in seconds: " << t << endl;
+
+    return workspace.global_CM;
+}
+
+Mat generateSaliencyProto(Mat input, float* objectFeatures, bool avgGlobal, bool debug, const SaliencyOptions& options)
+{
+    SaliencyWorkspace workspace;
+    return generateSaliencyProto(input, objectFeatures, avgGlobal, debug, options, workspace);
+}
+
+/**
+ * generateSaliencyProto with caller-owned buffers, e.g. for the frames of a
+ * camera stream: after the first call for a frame size nothing is allocated
+ * (outside lowMemory mode, see SaliencyWorkspace). The returned map points into the workspace and is overwritten by the next
+ * call.
+ */
+Mat generateSaliencyProto(Mat input, float* objectFeatures, bool avgGlobal, bool debug, const SaliencyOptions& options,
+                          SaliencyWorkspace& workspace)
+{
+    printFeatureValues(objectFeatures);
+
+    // winner-take-all only ever used the conspicuity maps
+    combined_saliency_map(input, objectFeatures, avgGlobal ? NUM_BASE_MAPS : 3, avgGlobal, debug, options,
+                          workspace);
+
+    return workspace.global_CM;
+}
+
+
+/**
+ * Outputs the best proposal (or the first to exceed a specific threshold)
+ * @param  image    [description]
+ * @param  objProps [description]
+ * @param  thresh   a percentage confidence multipled by 10,000
+ * @return          The best proposal (or first to exceed threshold)
+ */
+proposal topPropoal(Mat& image, proposal* objProps, int numProposals, float* features, int thresh, const SaliencyOptions& options)
+{
+    int top = 0;
+    topProposals(image, objProps, numProposals, features, 1, &top, thresh, options);
+    return objProps[top];
+}
+
+/**
+ * Ranks the proposals of an image for one object without any display: the
+ * saliency map of generateSaliencyProto (average of all base maps) is built
+ * once, at the size of the conspicuity maps (see proposal_options), and the
+ * proposals are scored on it at its own scale in parallel chunks (see
+ * topKProposals and firstProposalAbove). The result does not depend on the
+ * number of threads.
+ *
+ * @param  image        input image
+ * @param  objProps     proposals, the saliencyScore of the scored ones is set
+ * @param  numProposals number of proposals
+ * @param  features     feature weights of the object
+ * @param  k            number of proposals to return
+ * @param  topIndices   output, the proposal indices (at least k entries)
+ * @param  thresh       if not negative, return only the first proposal in
+ *                      input order with a score above thresh when there is
+ *                      one (the remaining proposals may not be scored and
+ *                      keep their previous saliencyScore, which may be stale)
+ * @param  options      pipeline options
+ * @return              number of indices written: 1 for a proposal above
+ *                      thresh, otherwise min(k, numProposals) proposals by
+ *                      decreasing score (ties keep the proposal order)
+ */
+int topProposals(Mat& image, proposal* objProps, int numProposals, float* features, int k, int* topIndices,
+                 int thresh, const SaliencyOptions& options)
+{
+    SaliencyWorkspace workspace;
+    return topProposals(image, objProps, numProposals, features, k, topIndices, thresh, options, workspace);
+}
+
+/**
+ * topProposals with caller-owned pipeline buffers, e.g. for the frames of a
+ * camera stream (see SaliencyWorkspace).
+ */
+int topProposals(Mat& image, proposal* objProps, int numProposals, float* features, int k, int* topIndices,
+                 int thresh, const SaliencyOptions& options, SaliencyWorkspace& workspace)
+{
+    BaseMaps baseMaps;
+    computeBaseMaps(image, baseMaps, false, proposal_options(options), workspace);
+
+    Mat saliencyMap, integralMap;
+    combineBaseMaps(baseMaps, features, NUM_BASE_MAPS, true, saliencyMap);
+    saliencyIntegral(saliencyMap, integralMap);
+
+    if (thresh >= 0 && k > 0)
+    {
+        int first = firstProposalAbove(integralMap, image.size(), objProps, numProposals, thresh);
+        if (first >= 0)
+        {
+            topIndices[0] = first;
+            return 1;
+        }
+
+        // no early exit: every proposal is scored already
+        return topKProposals(integralMap, image.size(), objProps, numProposals, k, topIndices, false);
+    }
+    return topKProposals(integralMap, image.size(), objProps, numProposals, k, topIndices);
+}
+
+/**
+ * topProposals through the coarse-to-fine cascade (see cascadeTopProposals):
+ * every proposal is scored on a downsampled saliency map and only the
+ * survivors on the map itself, which is at the size of the conspicuity maps
+ * (see proposal_options).
+ *
+ * @param  image        input image
+ * @param  objProps     proposals, the saliencyScore of the survivors is set
+ * @param  numProposals number of proposals
+ * @param  features     feature weights of the object
+ * @param  k            number of proposals to return
+ * @param  topIndices   output, the proposal indices (at least k entries)
+ * @param  cascade      cascade options
+ * @param  stats        cascade statistics to accumulate into, or NULL
+ * @param  options      pipeline options
+ * @return              number of indices written
+ */
+int cascadeProposals(Mat& image, proposal* objProps, int numProposals, float* features, int k, int* topIndices,
+                     const CascadeOptions& cascade, CascadeStats* stats, const SaliencyOptions& options)
+{
+    SaliencyWorkspace workspace;
+    return cascadeProposals(image, objProps, numProposals, features, k, topIndices, cascade, stats, options,
+                            workspace);
+}
+
+/**
+ * cascadeProposals with caller-owned pipeline buffers (see SaliencyWorkspace).
+ */
+int cascadeProposals(Mat& image, proposal* objProps, int numProposals, float* features, int k, int* topIndices,
+                     const CascadeOptions& cascade, CascadeStats* stats, const SaliencyOptions& options,
+                     SaliencyWorkspace& workspace)
+{
+    BaseMaps baseMaps;
+    computeBaseMaps(image, baseMaps, false, proposal_options(options), workspace);
+
+    Mat saliencyMap, integralMap;
+    combineBaseMaps(baseMaps, features, NUM_BASE_MAPS, true, saliencyMap);
+    saliencyIntegral(saliencyMap, integralMap);
+    return cascadeTopProposals(integralMap, image.size(), objProps, numProposals, k, topIndices, cascade, stats);
+}
+
+/**
+ * Orders proposal indices by decreasing score (for rankProposals).
+ */
+struct ScoreOrder
+{
+    const int* scores;
+
+    ScoreOrder(const int* scores) : scores(scores) {}
+
+    bool operator()(int a, int b) const
+    {
+        return scores[a] > scores[b];
+    }
+};
+
+/**
+ * Ranks the proposals for several objects at once, e.g. to look for any of a
+ * set of object classes. The base maps are computed once, at the size of the
+ * conspicuity maps (see proposal_options), the object maps of all classes
+ * are combined in one batch and every proposal is scored against all of
+ * them in a single sweep over the proposals, from the summed-area tables of
+ * the maps at their own scale (see mapSaliencyScore).
+ *
+ * @param image        input image
+ * @param objProps     proposals
+ * @param numProposals number of proposals
+ * @param features     numObjects feature vectors (see learnFeaturefromDataset)
+ * @param numObjects   number of objects
+ * @param scores       output, numObjects x numProposals saliency scores
+ *                     (row-major, see calculateSaliencyScore)
+ * @param rankings     output, numObjects x numProposals proposal indices, each
+ *                     row ordered by decreasing score of its object (ties
+ *                     keep the proposal order)
+ * @param options      pipeline options
+ */
+void rankProposals(Mat& image, proposal* objProps, int numProposals, float** features, int numObjects,
+                   int* scores, int* rankings, const SaliencyOptions& options)
+{
+    SaliencyWorkspace workspace;
+    rankProposals(image, objProps, numProposals, features, numObjects, scores, rankings, options, workspace);
+}
+
+/**
+ * rankProposals with caller-owned pipeline buffers (see SaliencyWorkspace).
+ */
+void rankProposals(Mat& image, proposal* objProps, int numProposals, float** features, int numObjects,
+                   int* scores, int* rankings, const SaliencyOptions& options, SaliencyWorkspace& workspace)
+{
+    if (numObjects <= 0)
+    {
+        return;
+    }
+
+    BaseMaps baseMaps;
+    computeBaseMaps(image, baseMaps, false, proposal_options(options), workspace);
+
+    vector<Mat> saliencyMaps(numObjects), integralMaps(numObjects);
+    combineBaseMapsBatch(baseMaps, features, numObjects, &saliencyMaps[0]);
+    for (int k = 0; k < numObjects; ++k)
+    {
+        saliencyIntegral(saliencyMaps[k], integralMaps[k]);
+    }
+
+    vector<int> propScores(numObjects);
+    for (int i = 0; i < numProposals; ++i)
+    {
+        mapSaliencyScores(&integralMaps[0], numObjects, image.size(), objProps[i], &propScores[0]);
+        for (int k = 0; k < numObjects; ++k)
+        {
+            scores[k * numProposals + i] = propScores[k];
+        }
+    }
+
+    for (int k = 0; k < numObjects; ++k)
+    {
+        int* ranking = rankings + k * numProposals;
+        for (int i = 0; i < numProposals; ++i)
+        {
+            ranking[i] = i;
+        }
+        std::stable_sort(ranking, ranking + numProposals, ScoreOrder(scores + k * numProposals));
+    }
+}
+
+float* learnFeature(Mat& image, proposal prop, const SaliencyOptions& options)
+{
+    float* score = new float[3];
+
+    // the base maps are computed once (at the size of the conspicuity maps,
+    // see proposal_options), each feature only reweights them
+    BaseMaps baseMaps;
+    computeBaseMaps(image, baseMaps, false, proposal_options(options));
+
+    for (int k = 0; k < 3; k++)
+    {
+        // initialize feature vector for feature k
+        float features[3] = {0.0, 0.0, 0.0};
+        features[k] = 1.0;
+
+        Mat saliency, integralMap;
+        combineBaseMaps(baseMaps, features, 3, false, saliency);
+
+        // Score calculated from the same Saliency evaluation function, with
+        // the box mapped onto the map instead of the map resized to the image
+        saliencyIntegral(saliency, integralMap);
+        score[k] = (float) mapSaliencyScore(integralMap, image.size(), prop);
+    }
+
+    // Normalize score vector
+    float sum = score[0] + score[1] + score[2];
+    score[0] = score[0] / sum;
+    score[1] = score[1] / sum;
+    score[2] = score[2] / sum;
+
+    return score;
+}
+
+float* learnFeaturefromDataset(const char *databasePath, int numFeatures, const SaliencyOptions& options)
+{
+    float* featureSums = new float[numFeatures];
+    int numExamples = 0;
+    string imgName, imgPath;
+    int maxExamples = 1000;
+
+    for(int i = 0; i < numFeatures; i++)
+    {
+        featureSums[i] = 0;
+    }
+
+    DIR *dir;
+    struct dirent *ent;
+    if ((dir = opendir (databasePath)) != NULL) {
+      /* print all the files and directories within directory */
+      while ((ent = readdir (dir)) != NULL && numExamples < maxExamples) {
+        imgName = ent -> d_name;
+        if((imgName).find("jpg") != std::string::npos)
+        {
+
+            imgPath = (string) databasePath + "/" + imgName;
+            // cout << imgPath << endl;
+            Mat input = imread(imgPath , CV_LOAD_IMAGE_COLOR);
+            // cout << imgPath << endl;
+            float* instanceFeatures = calculateSaliencyFeaturesProto(input, options);
+
+            numExamples = numExamples + 1;
+            for(int i = 0; i < numFeatures; i++)
+            {
+                featureSums[i] = featureSums[i] + instanceFeatures[i];
+            }
+
+        }
+      }
+      closedir (dir);
+
+      if (numExamples > 0)
+      {
+          for(int i = 0; i < numFeatures; i++)
+          {
+              featureSums[i] = featureSums[i] / numExamples;
+              cout << i << ":\t" << featureSums[i] << endl;
+          }
+      } else
+      {
+          for(int i = 0; i < numFeatures; i++)
+          {
+              featureSums[i] = 0.0;
+          }
+      }
+
+    } else {
+      /* could not open directory */
+      perror ("");
+    }
+
+    return featureSums;
+}
+
+
+float* calculateSaliencyFeaturesProto(Mat& input, const SaliencyOptions& options)
+{
+    SaliencyWorkspace workspace;
+    return calculateSaliencyFeaturesProto(input, options, workspace);
+}
+
+/**
+ * calculateSaliencyFeaturesProto with caller-owned buffers (see
+ * SaliencyWorkspace); only the returned feature array is allocated.
+ */
+float* calculateSaliencyFeaturesProto(Mat& input, const SaliencyOptions& options, SaliencyWorkspace& workspace)
+{
+    BaseMaps baseMaps;
+    computeBaseMaps(input, baseMaps, false, options, workspace);
+    return baseMapFeatures(baseMaps);
+}
+
+void printFeatureValues(float* features)
+{
+    cout << endl << "Saliency Feature Values: " << endl;
+    cout << "Intensity conspicuity :    \t"    <<  features[0] << endl;
+    cout << "Orientation conspicuity :  \t"    <<  features[1] << endl;
+    cout << "Opponency conspicuity :    \t"    <<  features[2] << endl;
+    cout << "Red Filter :               \t"    <<  features[3] << endl;
+    cout << "Green Filter :             \t"    <<  features[4] << endl;
+    cout << "Blue Filter :              \t"    <<  features[5] << endl;
+    cout << "Yellow Filter :            \t"    <<  features[6] << endl;
+    cout << "0-degree orientation :     \t"    <<  features[7] << endl;
+    cout << "45-degree orientation :    \t"    <<  features[8] << endl;
+    cout << "90-degree orientation :    \t"    <<  features[9] << endl;
+    cout << "135-degree orientation :   \t"    <<  features[10] << endl;
+}
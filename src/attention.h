@@ -0,0 +1,64 @@
+/**
+* Top-down saliency pipeline: object specific saliency maps, feature learning
+* and proposal ranking (see attention.cpp).
+*/
+
+#include "saliency.h"
+#include "normalize.h"
+#include "gabor.h"
+#include "spectral.h"
+#include "objectProposal.h"
+#include <dirent.h>
+
+#ifndef ATTENTION_H
+#define ATTENTION_H
+
+const int NUM_BASE_MAPS = 11;
+
+/**
+* The normalized base maps of one image, all at the size of the working image
+* (the input downsampled to options.startScale; the spectral backend works
+* on a smaller image, see spectral_size), or of the conspicuity maps with
+* options.coarseMaps, in the order of the feature vector:
+* 	0-2   intensity, orientation and opponency conspicuity maps
+* 	3-6   red, green, blue and yellow channels
+* 	7-10  0, 45, 90 and 135 degree orientation maps
+* Object specific saliency maps (combineBaseMaps) and feature vectors
+* (baseMapFeatures) are computed from them without running the pipeline
+* again. When computed with a workspace the maps point into it and are
+* overwritten by the next call.
+*/
+struct BaseMaps
+{
+    cv::Mat maps[NUM_BASE_MAPS];
+};
+
+void computeBaseMaps(cv::Mat&, BaseMaps&, bool = false, const SaliencyOptions& = SaliencyOptions());
+void computeBaseMaps(cv::Mat&, BaseMaps&, bool, const SaliencyOptions&, SaliencyWorkspace&);
+void combineBaseMaps(const BaseMaps&, const float*, int, bool, cv::Mat&);
+void combineBaseMapsBatch(const BaseMaps&, float**, int, cv::Mat*);
+float* baseMapFeatures(const BaseMaps&);
+void baseMapProposalFeatures(const BaseMaps&, cv::Size, proposal*, int, float*, float*);
+void proposalFeatures(cv::Mat&, proposal*, int, float*, float*, const SaliencyOptions& = SaliencyOptions());
+void proposalFeatures(cv::Mat&, proposal*, int, float*, float*, const SaliencyOptions&, SaliencyWorkspace&);
+cv::Mat generateSaliency(cv::Mat, float*, bool, bool, const SaliencyOptions& = SaliencyOptions());
+cv::Mat generateSaliency(cv::Mat, float*, bool, bool, const SaliencyOptions&, SaliencyWorkspace&);
+cv::Mat generateSaliencyProto(cv::Mat, float*, bool, bool, const SaliencyOptions& = SaliencyOptions());
+cv::Mat generateSaliencyProto(cv::Mat, float*, bool, bool, const SaliencyOptions&, SaliencyWorkspace&);
+proposal topPropoal(cv::Mat&, proposal*, int, float*, int, const SaliencyOptions& = SaliencyOptions());
+int topProposals(cv::Mat&, proposal*, int, float*, int, int*, int = -1, const SaliencyOptions& = SaliencyOptions());
+int topProposals(cv::Mat&, proposal*, int, float*, int, int*, int, const SaliencyOptions&, SaliencyWorkspace&);
+int cascadeProposals(cv::Mat&, proposal*, int, float*, int, int*, const CascadeOptions& = CascadeOptions(),
+                     CascadeStats* = NULL, const SaliencyOptions& = SaliencyOptions());
+int cascadeProposals(cv::Mat&, proposal*, int, float*, int, int*, const CascadeOptions&, CascadeStats*,
+                     const SaliencyOptions&, SaliencyWorkspace&);
+void rankProposals(cv::Mat&, proposal*, int, float**, int, int*, int*, const SaliencyOptions& = SaliencyOptions());
+void rankProposals(cv::Mat&, proposal*, int, float**, int, int*, int*, const SaliencyOptions&, SaliencyWorkspace&);
+float* learnFeature(cv::Mat&, proposal, const SaliencyOptions& = SaliencyOptions());
+float* learnFeatureProto(cv::Mat&, proposal);
+float* learnFeaturefromDataset(const char *, int, const SaliencyOptions& = SaliencyOptions());
+float* calculateSaliencyFeaturesProto(cv::Mat&, const SaliencyOptions& = SaliencyOptions());
+float* calculateSaliencyFeaturesProto(cv::Mat&, const SaliencyOptions&, SaliencyWorkspace&);
+void printFeatureValues(float* );
+
+#endif
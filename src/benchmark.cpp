@@ -0,0 +1,1383 @@
+/**
+* Microbenchmarks for the saliency pipeline kernels.
+*
+* Usage:
+*   benchmark rgbyi <image> [iterations]
+*       split_rgbyi (vectorized) against split_rgbyi_reference (per-pixel loop)
+*   benchmark gabor <image> [iterations]
+*       orientation maps with every GaborBank method, against DIRECT
+*   benchmark steer <image> [iterations]
+*       8 and 16 orientations with one kernel each against steerable bases
+*   benchmark threads <image> [iterations]
+*       saliency features with 1, 2, 4, 8 and 16 threads, checked to be
+*       identical to the single thread result, and the time of each stage
+*       of conspicuity_pyramids
+*   benchmark workspace <image> [iterations]
+*       saliency maps with a new SaliencyWorkspace per frame against one
+*       reused workspace
+*   benchmark multiclass <image> [iterations]
+*       saliency maps of 15 objects from separate pipelines against one set of
+*       base maps combined in a batch
+*   benchmark precision <image> [iterations]
+*       saliency maps with fp32 against 16 bit fixed point channel pyramids
+*   benchmark spectral <image> [iterations]
+*       saliency maps of the spectral residual backend against the Itti
+*       pipeline
+*   benchmark scoring <image> [iterations]
+*       proposal scores with cv::sum over every box against lookups in a
+*       summed-area table of the map, for 10000 and 100000 random boxes
+*   benchmark descriptors <image> [iterations]
+*       per-proposal base map means with cv::mean over every box against one
+*       interleaved summed-area table, for 10000 random boxes
+*   benchmark topk <image> [iterations]
+*       top 10 of 100000 random proposals and the first above a threshold,
+*       serial scan against parallel chunks with 1 to 16 threads, checked
+*       to give the same proposals
+*   benchmark memory <image>
+*       peak memory of one saliency map in the default and --low-memory modes
+*   benchmark startscale <class folder> [max images]
+*       generateSaliencyProto started at pyramid levels 1 and 2 against full
+*       resolution, on one class of the 4Progress dataset (see report_dataset)
+*   benchmark resampling <class folder> [max images]
+*       the fast and fastest resampling tiers against exact, on one class of
+*       the 4Progress dataset
+*   benchmark boxdog <class folder> [max images]
+*       box mean (summed-area table) center-surround against the pyramid
+*       engine, on one class of the 4Progress dataset
+*   benchmark coarse <class folder> [max images]
+*       base maps at the size of the conspicuity maps against the size of
+*       the image, on one class of the 4Progress dataset
+*   benchmark cascade <class folder> [max images]
+*       coarse-to-fine proposal scoring with several survival ratios and
+*       bounds against exhaustive scoring, on one class of the 4Progress
+*       dataset: scoring time, survivors and how often the winner changes
+*
+* Timings are the average over all iterations, after one warm-up run.
+*/
+
+#include "attention.h"
+#include "util.h"
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace std;
+using namespace cv;
+
+int benchmark_rgbyi(Mat&, int);
+int benchmark_gabor(Mat&, int);
+int benchmark_steer(Mat&, int);
+int benchmark_threads(Mat&, int);
+int benchmark_workspace(Mat&, int);
+int benchmark_multiclass(Mat&, int);
+int benchmark_precision(Mat&, int);
+int benchmark_spectral(Mat&, int);
+int benchmark_scoring(Mat&, int);
+int benchmark_descriptors(Mat&, int);
+int benchmark_topk(Mat&, int);
+int benchmark_memory(Mat&);
+int benchmark_startscale(const string&, int);
+int benchmark_resampling(const string&, int);
+int benchmark_boxdog(const string&, int);
+int benchmark_coarse(const string&, int);
+int benchmark_cascade(const string&, int);
+int report_dataset(const string&, const SaliencyOptions&, const SaliencyOptions&, int);
+double rank_correlation(const vector<double>&, const vector<double>&);
+double max_abs_diff(Mat&, Mat&);
+void print_usage();
+
+
+int main( int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        print_usage();
+        return 1;
+    }
+
+    string mode = argv[1];
+
+    if (mode == "startscale")
+    {
+        return benchmark_startscale(argv[2], (argc > 3) ? atoi(argv[3]) : 0);
+    }
+    if (mode == "resampling")
+    {
+        return benchmark_resampling(argv[2], (argc > 3) ? atoi(argv[3]) : 0);
+    }
+    if (mode == "boxdog")
+    {
+        return benchmark_boxdog(argv[2], (argc > 3) ? atoi(argv[3]) : 0);
+    }
+    if (mode == "coarse")
+    {
+        return benchmark_coarse(argv[2], (argc > 3) ? atoi(argv[3]) : 0);
+    }
+    if (mode == "cascade")
+    {
+        return benchmark_cascade(argv[2], (argc > 3) ? atoi(argv[3]) : 0);
+    }
+
+    int iterations = (argc > 3) ? atoi(argv[3]) : 50;
+
+    Mat input = imread(argv[2], CV_LOAD_IMAGE_COLOR);
+    if (input.empty())
+    {
+        cout << "Could not read image " << argv[2] << endl;
+        return 1;
+    }
+
+    if (mode == "rgbyi")
+    {
+        return benchmark_rgbyi(input, iterations);
+    }
+    if (mode == "gabor")
+    {
+        return benchmark_gabor(input, iterations);
+    }
+    if (mode == "steer")
+    {
+        return benchmark_steer(input, iterations);
+    }
+    if (mode == "threads")
+    {
+        return benchmark_threads(input, iterations);
+    }
+    if (mode == "workspace")
+    {
+        return benchmark_workspace(input, iterations);
+    }
+    if (mode == "multiclass")
+    {
+        return benchmark_multiclass(input, iterations);
+    }
+    if (mode == "precision")
+    {
+        return benchmark_precision(input, iterations);
+    }
+    if (mode == "spectral")
+    {
+        return benchmark_spectral(input, iterations);
+    }
+    if (mode == "scoring")
+    {
+        return benchmark_scoring(input, iterations);
+    }
+    if (mode == "descriptors")
+    {
+        return benchmark_descriptors(input, iterations);
+    }
+    if (mode == "topk")
+    {
+        return benchmark_topk(input, iterations);
+    }
+    if (mode == "memory")
+    {
+        return benchmark_memory(input);
+    }
+
+    print_usage();
+    return 1;
+}
+
+void print_usage()
+{
+    cout << "Usage: benchmark rgbyi <image> [iterations]" << endl;
+    cout << "       benchmark gabor <image> [iterations]" << endl;
+    cout << "       benchmark steer <image> [iterations]" << endl;
+    cout << "       benchmark threads <image> [iterations]" << endl;
+    cout << "       benchmark workspace <image> [iterations]" << endl;
+    cout << "       benchmark multiclass <image> [iterations]" << endl;
+    cout << "       benchmark precision <image> [iterations]" << endl;
+    cout << "       benchmark spectral <image> [iterations]" << endl;
+    cout << "       benchmark scoring <image> [iterations]" << endl;
+    cout << "       benchmark descriptors <image> [iterations]" << endl;
+    cout << "       benchmark topk <image> [iterations]" << endl;
+    cout << "       benchmark memory <image>" << endl;
+    cout << "       benchmark startscale <class folder> [max images]" << endl;
+    cout << "       benchmark resampling <class folder> [max images]" << endl;
+    cout << "       benchmark boxdog <class folder> [max images]" << endl;
+    cout << "       benchmark coarse <class folder> [max images]" << endl;
+    cout << "       benchmark cascade <class folder> [max images]" << endl;
+}
+
+/**
+* Largest absolute difference between two single channel float images
+*/
+double max_abs_diff(Mat& a, Mat& b)
+{
+    Mat diff;
+    double maxDiff;
+    absdiff(a, b, diff);
+    minMaxLoc(diff, NULL, &maxDiff, NULL, NULL);
+    return maxDiff;
+}
+
+/**
+* Times the channel extraction and checks the vectorized output against the
+* reference loop.
+*
+* @param  input      BGR image
+* @param  iterations number of timed runs for each version
+* @return            0 if the outputs agree within the documented tolerance
+*/
+int benchmark_rgbyi(Mat& input, int iterations)
+{
+    Mat reference[5], channels[5];
+    const char* names[5] = {"red", "green", "blue", "yellow", "intensity"};
+
+    // warm up (and allocate the outputs of the vectorized version)
+    split_rgbyi_reference(input, reference);
+    split_rgbyi(input, channels);
+
+    double t = (double)getTickCount();
+    for (int i = 0; i < iterations; i++)
+    {
+        split_rgbyi_reference(input, reference);
+    }
+    double tRef = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+    t = (double)getTickCount();
+    for (int i = 0; i < iterations; i++)
+    {
+        split_rgbyi(input, channels);
+    }
+    double tVec = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+    double mpix = input.rows * input.cols / 1e6;
+    cout << "Image " << input.cols << "x" << input.rows << ", " << iterations << " iterations" << endl;
+    cout << "reference loop : " << tRef * 1000 << " ms\t" << mpix / tRef << " Mpixel/s" << endl;
+    cout << "vectorized     : " << tVec * 1000 << " ms\t" << mpix / tVec << " Mpixel/s" << endl;
+    cout << "speedup        : " << tRef / tVec << "x" << endl;
+
+    int status = 0;
+    for (int k = 0; k < 5; k++)
+    {
+        double diff = max_abs_diff(reference[k], channels[k]);
+        cout << "max |diff| " << names[k] << ":\t" << diff << endl;
+        if (diff > 1e-6)
+        {
+            status = 1;
+        }
+    }
+    return status;
+}
+
+/**
+* Times the Gabor bank on the intensity channel with each method and reports
+* the largest difference from the direct filter2D output.
+*
+* @param  input      BGR image
+* @param  iterations number of timed runs for each method
+* @return            0
+*/
+int benchmark_gabor(Mat& input, int iterations)
+{
+    Mat channels[5];
+    split_rgbyi(input, channels);
+
+    GaborBank& bank = cached_gabor_bank(itti_gabor_params());
+    const char* names[4] = {"AUTO", "DIRECT", "SEPARABLE", "FFT"};
+
+    Mat direct[4], output[4];
+    bank.apply(channels[4], direct, GaborBank::DIRECT);
+
+    cout << "Image " << input.cols << "x" << input.rows << ", " << iterations << " iterations" << endl;
+    cout << "AUTO picks " << names[bank.choose_method(channels[4].size())] << endl;
+
+    for (int m = 0; m < 4; m++)
+    {
+        GaborBank::Method method = (GaborBank::Method) m;
+        bank.apply(channels[4], output, method);
+
+        double t = (double)getTickCount();
+        for (int i = 0; i < iterations; i++)
+        {
+            bank.apply(channels[4], output, method);
+        }
+        t = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+        double diff = 0;
+        for (int k = 0; k < 4; k++)
+        {
+            diff = std::max(diff, max_abs_diff(direct[k], output[k]));
+        }
+        cout << names[m] << ":\t" << t * 1000 << " ms\tmax |diff| " << diff << endl;
+    }
+    return 0;
+}
+
+/**
+* Times 8 and 16 orientation maps computed with one Gabor kernel per
+* orientation and with steerable bases of 4, 6 and 8 kernels, and reports the
+* worst steering error and output difference of every basis.
+*
+* @param  input      BGR image
+* @param  iterations number of timed runs for each configuration
+* @return            0
+*/
+int benchmark_steer(Mat& input, int iterations)
+{
+    Mat channels[5];
+    split_rgbyi(input, channels);
+
+    cout << "Image " << input.cols << "x" << input.rows << ", " << iterations << " iterations" << endl;
+
+    for (int numOrient = 8; numOrient <= 16; numOrient *= 2)
+    {
+        GaborParams params = itti_gabor_params(numOrient);
+        GaborBank& bank = cached_gabor_bank(params);
+        vector<Mat> direct(numOrient), steered(numOrient);
+
+        bank.apply(channels[4], &direct[0]);
+        double t = (double)getTickCount();
+        for (int i = 0; i < iterations; i++)
+        {
+            bank.apply(channels[4], &direct[0]);
+        }
+        t = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+        cout << numOrient << " orientations, one kernel each:\t" << t * 1000 << " ms" << endl;
+
+        for (int basisSize = 4; basisSize <= 8; basisSize += 2)
+        {
+            SteerableGabor& steerable = cached_steerable_gabor(basisSize);
+            steerable.apply(channels[4], params.thetas, &steered[0]);
+
+            t = (double)getTickCount();
+            for (int i = 0; i < iterations; i++)
+            {
+                steerable.apply(channels[4], params.thetas, &steered[0]);
+            }
+            t = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+            double kernelError = 0, diff = 0;
+            for (int k = 0; k < numOrient; k++)
+            {
+                kernelError = std::max(kernelError, steerable.steering_error(params.thetas[k]));
+                diff = std::max(diff, max_abs_diff(direct[k], steered[k]));
+            }
+            cout << numOrient << " orientations, steerable basis " << basisSize << ":\t"
+                 << t * 1000 << " ms\tkernel error " << kernelError << "\tmax |diff| " << diff << endl;
+        }
+    }
+    return 0;
+}
+
+/**
+* Times calculateSaliencyFeaturesProto (the whole pipeline up to the feature
+* means) with thread pools of 1 to 16 threads and checks that every thread
+* count gives exactly the single thread features. The stages of
+* conspicuity_pyramids, the parallel part, are timed separately on a reused
+* workspace, with their speedup over one thread.
+*
+* @param  input      BGR image
+* @param  iterations number of timed runs for each thread count
+* @return            0 if all results are identical
+*/
+int benchmark_threads(Mat& input, int iterations)
+{
+    SaliencyOptions options;
+    float reference[11];
+    double tSingle = 0;
+    double stageSingle[3] = {0, 0, 0};
+    const char* stageNames[3] = {"decimate", "pyramids", "conspicuity"};
+    int status = 0;
+
+    SaliencyWorkspace workspace(input.size(), options);
+    split_rgbyi(input, workspace.channels);
+
+    cout << "Image " << input.cols << "x" << input.rows << ", " << iterations << " iterations" << endl;
+
+    for (int numThreads = 1; numThreads <= 16; numThreads *= 2)
+    {
+        options.numThreads = numThreads;
+        apply_thread_count(options);
+
+        float* features = calculateSaliencyFeaturesProto(input, options);
+        double t = (double)getTickCount();
+        for (int i = 0; i < iterations; i++)
+        {
+            delete[] features;
+            features = calculateSaliencyFeaturesProto(input, options);
+        }
+        t = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+        bool identical = true;
+        if (numThreads == 1)
+        {
+            std::copy(features, features + 11, reference);
+            tSingle = t;
+        } else {
+            identical = std::equal(features, features + 11, reference);
+        }
+        delete[] features;
+
+        cout << numThreads << " threads:\t" << t * 1000 << " ms\tspeedup " << tSingle / t << "x"
+             << (identical ? "" : "\tRESULT DIFFERS") << endl;
+
+        double stages[3] = {0, 0, 0};
+        conspicuity_pyramids(workspace, options);
+        for (int i = 0; i < iterations; i++)
+        {
+            double seconds[3];
+            conspicuity_pyramids(workspace, options, seconds);
+            for (int s = 0; s < 3; s++)
+            {
+                stages[s] += seconds[s] / iterations;
+            }
+        }
+        for (int s = 0; s < 3; s++)
+        {
+            if (numThreads == 1)
+            {
+                stageSingle[s] = stages[s];
+            }
+            cout << "  " << stageNames[s] << ":\t" << stages[s] * 1000 << " ms\tspeedup "
+                 << stageSingle[s] / stages[s] << "x" << endl;
+        }
+        if (!identical)
+        {
+            status = 1;
+        }
+    }
+    return status;
+}
+
+/**
+* Times generateSaliencyProto on the same frame with a new workspace per call
+* and with one workspace reused for all calls (as for a camera stream). The
+* reused workspace must give the same map and hand back the same buffer on
+* every call, i.e. the steady state allocates no maps.
+*
+* @param  input      BGR image
+* @param  iterations number of frames for each version
+* @return            0 if the maps are identical and the buffer is reused
+*/
+int benchmark_workspace(Mat& input, int iterations)
+{
+    SaliencyOptions options;
+    float features[11];
+    std::fill(features, features + 11, 1.0f / 11);
+
+    Mat fresh = generateSaliencyProto(input, features, true, false, options);
+    double t = (double)getTickCount();
+    for (int i = 0; i < iterations; i++)
+    {
+        fresh = generateSaliencyProto(input, features, true, false, options);
+    }
+    double tFresh = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+    SaliencyWorkspace workspace(input.size(), options);
+    Mat reused = generateSaliencyProto(input, features, true, false, options, workspace);
+    const uchar* buffer = reused.data;
+    bool sameBuffer = true;
+
+    t = (double)getTickCount();
+    for (int i = 0; i < iterations; i++)
+    {
+        reused = generateSaliencyProto(input, features, true, false, options, workspace);
+        sameBuffer = sameBuffer && reused.data == buffer;
+    }
+    double tReused = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+    double diff = max_abs_diff(fresh, reused);
+    cout << "Image " << input.cols << "x" << input.rows << ", " << iterations << " frames" << endl;
+    cout << "new workspace per frame : " << tFresh * 1000 << " ms" << endl;
+    cout << "reused workspace        : " << tReused * 1000 << " ms" << endl;
+    cout << "speedup                 : " << tFresh / tReused << "x" << endl;
+    cout << "max |diff|              : " << diff << endl;
+    cout << "output buffer reused    : " << (sameBuffer ? "yes" : "no") << endl;
+    return (diff == 0 && sameBuffer) ? 0 : 1;
+}
+
+/**
+* Times the saliency maps of 15 objects (the classes of the 4Progress
+* dataset) computed as 15 separate generateSaliencyProto runs against one
+* computeBaseMaps and a single batched combination. The weight vectors are
+* random but fixed. generateSaliencyProto sums the conspicuity maps at their
+* own size and resizes the sum, where the batch sums the resized maps, so the
+* maps only agree up to float rounding: the batched maps (in [0, 1]) must be
+* within 1e-4 of the separate ones.
+*
+* @param  input      BGR image
+* @param  iterations number of timed runs for each version
+* @return            0 if the maps agree
+*/
+int benchmark_multiclass(Mat& input, int iterations)
+{
+    const int numObjects = 15;
+    const double tolerance = 1e-4;
+    SaliencyOptions options;
+
+    RNG rng(12345);
+    float* features[numObjects];
+    for (int k = 0; k < numObjects; k++)
+    {
+        features[k] = new float[NUM_BASE_MAPS];
+        for (int i = 0; i < NUM_BASE_MAPS; i++)
+        {
+            features[k][i] = rng.uniform(0.0f, 1.0f);
+        }
+    }
+
+    Mat separate[numObjects], batched[numObjects];
+    double t = (double)getTickCount();
+    for (int n = 0; n < iterations; n++)
+    {
+        for (int k = 0; k < numObjects; k++)
+        {
+            separate[k] = generateSaliencyProto(input, features[k], true, false, options);
+        }
+    }
+    double tSeparate = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+    t = (double)getTickCount();
+    for (int n = 0; n < iterations; n++)
+    {
+        BaseMaps baseMaps;
+        computeBaseMaps(input, baseMaps, false, options);
+        combineBaseMapsBatch(baseMaps, features, numObjects, batched);
+    }
+    double tBatched = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+    double diff = 0;
+    for (int k = 0; k < numObjects; k++)
+    {
+        diff = std::max(diff, max_abs_diff(separate[k], batched[k]));
+        delete[] features[k];
+    }
+
+    cout << "Image " << input.cols << "x" << input.rows << ", " << numObjects << " objects, "
+         << iterations << " iterations" << endl;
+    cout << "separate pipelines : " << tSeparate * 1000 << " ms" << endl;
+    cout << "batched            : " << tBatched * 1000 << " ms" << endl;
+    cout << "speedup            : " << tSeparate / tBatched << "x" << endl;
+    cout << "max |diff|         : " << diff << " (tolerance " << tolerance << ")" << endl;
+    return (diff <= tolerance) ? 0 : 1;
+}
+
+/**
+* Bytes of the pyramid levels above the input level of the channel pyramids
+* of a workspace (the levels a pyramid stores itself).
+*/
+static size_t pyramid_bytes(SaliencyWorkspace& workspace, int inputLevel)
+{
+    size_t bytes = 0;
+    for (int k = 0; k < 5; k++)
+    {
+        Pyramid& pyramid = workspace.pyramids[k];
+        for (int level = inputLevel + 1; level < pyramid.levels(); level++)
+        {
+            bytes += pyramid[level].total() * pyramid[level].elemSize();
+        }
+    }
+    return bytes;
+}
+
+/**
+* Times generateSaliencyProto with fp32 and with 16 bit fixed point channel
+* pyramids (options.fixedPoint), each with a reused workspace, and reports
+* the memory of the channel pyramids and the difference of the final maps.
+*
+* @param  input      BGR image
+* @param  iterations number of timed runs for each version
+* @return            0
+*/
+int benchmark_precision(Mat& input, int iterations)
+{
+    float features[11];
+    std::fill(features, features + 11, 1.0f / 11);
+
+    const char* names[2] = {"fp32       ", "fixed point"};
+    Mat maps[2];
+    cout << "Image " << input.cols << "x" << input.rows << ", " << iterations << " iterations" << endl;
+
+    for (int fixedPoint = 0; fixedPoint <= 1; fixedPoint++)
+    {
+        SaliencyOptions options;
+        options.fixedPoint = fixedPoint;
+        SaliencyWorkspace workspace(input.size(), options);
+
+        generateSaliencyProto(input, features, true, false, options, workspace);
+        double t = (double)getTickCount();
+        for (int i = 0; i < iterations; i++)
+        {
+            generateSaliencyProto(input, features, true, false, options, workspace);
+        }
+        t = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+        maps[fixedPoint] = generateSaliencyProto(input, features, true, false, options, workspace).clone();
+
+        cout << names[fixedPoint] << " : " << t * 1000 << " ms, channel pyramids "
+             << pyramid_bytes(workspace, options.startScale) / 1024 << " kB" << endl;
+    }
+
+    Mat diff;
+    absdiff(maps[0], maps[1], diff);
+    cout << "final map max |diff|  : " << max_abs_diff(maps[0], maps[1]) << endl;
+    cout << "final map mean |diff| : " << mean(diff)[0] << endl;
+    return 0;
+}
+
+/**
+* Times generateSaliencyProto with the Itti and the spectral residual
+* backends, each with a reused workspace, and reports the correlation of the
+* two maps (at the size of the input).
+*
+* @param  input      BGR image
+* @param  iterations number of timed runs for each backend
+* @return            0
+*/
+int benchmark_spectral(Mat& input, int iterations)
+{
+    float features[11];
+    std::fill(features, features + 11, 1.0f / 11);
+
+    const char* names[2] = {"itti    ", "spectral"};
+    const SaliencyBackend backends[2] = {BACKEND_ITTI, BACKEND_SPECTRAL};
+    Mat maps[2];
+    cout << "Image " << input.cols << "x" << input.rows << ", " << iterations << " iterations" << endl;
+
+    for (int b = 0; b < 2; b++)
+    {
+        SaliencyOptions options;
+        options.backend = backends[b];
+        SaliencyWorkspace workspace;
+
+        generateSaliencyProto(input, features, true, false, options, workspace);
+        double t = (double)getTickCount();
+        for (int i = 0; i < iterations; i++)
+        {
+            generateSaliencyProto(input, features, true, false, options, workspace);
+        }
+        t = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+        resize(generateSaliencyProto(input, features, true, false, options, workspace), maps[b], input.size());
+
+        cout << names[b] << " : " << t * 1000 << " ms, map "
+             << workspace.global_CM.cols << "x" << workspace.global_CM.rows << endl;
+    }
+
+    Mat correlation;
+    matchTemplate(maps[0], maps[1], correlation, TM_CCOEFF_NORMED);
+    cout << "map correlation : " << correlation.at<float>(0, 0) << endl;
+    return 0;
+}
+
+/**
+* Random boxes inside an image, as proposals.
+*
+* @param size         image size
+* @param numProposals number of boxes
+* @param rng          random number generator
+* @return             the proposals (allocated, owned by the caller)
+*/
+static proposal* random_proposals(Size size, int numProposals, RNG& rng)
+{
+    proposal* props = new proposal[numProposals];
+    for (int i = 0; i < numProposals; i++)
+    {
+        int w = rng.uniform(8, size.width / 2);
+        int h = rng.uniform(8, size.height / 2);
+        props[i].bbox = Rect(rng.uniform(0, size.width - w), rng.uniform(0, size.height - h), w, h);
+        props[i].confScore = 0;
+        props[i].label = 1;
+    }
+    return props;
+}
+
+/**
+* Times the proposal scores of one saliency map (at the size of the input)
+* computed with cv::sum over each box (calculateSaliencyScore) against four
+* lookups per box in its summed-area table (integralSaliencyScore, the table
+* built once per map and included in the time), and counts the scores that
+* differ.
+*
+* @param  input      BGR image
+* @param  iterations number of timed runs for each version
+* @return            0 if no score differs by more than 1 (the rounding of
+*                    the box sums)
+*/
+int benchmark_scoring(Mat& input, int iterations)
+{
+    float features[11];
+    std::fill(features, features + 11, 1.0f / 11);
+
+    Mat saliencyMap;
+    resize(generateSaliencyProto(input, features, true, false), saliencyMap, input.size());
+
+    RNG rng(1);
+    int status = 0;
+    const int counts[2] = {10000, 100000};
+    for (int c = 0; c < 2; c++)
+    {
+        int numProposals = counts[c];
+        proposal* props = random_proposals(input.size(), numProposals, rng);
+        vector<int> reference(numProposals), scores(numProposals);
+
+        double t = (double)getTickCount();
+        for (int it = 0; it < iterations; it++)
+        {
+            for (int i = 0; i < numProposals; i++)
+            {
+                reference[i] = calculateSaliencyScore(saliencyMap, props[i]);
+            }
+        }
+        double tSum = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+        t = (double)getTickCount();
+        Mat integralMap;
+        for (int it = 0; it < iterations; it++)
+        {
+            saliencyIntegral(saliencyMap, integralMap);
+            for (int i = 0; i < numProposals; i++)
+            {
+                scores[i] = integralSaliencyScore(integralMap, props[i]);
+            }
+        }
+        double tIntegral = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+        int numDiffer = 0, maxDiff = 0;
+        for (int i = 0; i < numProposals; i++)
+        {
+            int diff = abs(scores[i] - reference[i]);
+            numDiffer += (diff > 0) ? 1 : 0;
+            maxDiff = std::max(maxDiff, diff);
+        }
+        status |= (maxDiff > 1) ? 1 : 0;
+
+        cout << numProposals << " proposals" << endl;
+        cout << "  cv::sum        : " << tSum * 1000 << " ms" << endl;
+        cout << "  integral image : " << tIntegral * 1000 << " ms (" << tSum / tIntegral << "x)" << endl;
+        cout << "  scores differing: " << numDiffer << ", max |diff| " << maxDiff << endl;
+        delete[] props;
+    }
+    return status;
+}
+
+/**
+* Times the means of the 11 base maps inside 10000 random boxes computed
+* with cv::mean per box and map against baseMapProposalFeatures (before the
+* group normalization, the table built once per image and included in the
+* time), and reports their largest difference. The base maps are at full
+* resolution, so both see the same pixels.
+*
+* @param  input      BGR image
+* @param  iterations number of timed runs for each version
+* @return            0 if the means agree to 1e-4
+*/
+int benchmark_descriptors(Mat& input, int iterations)
+{
+    const int numProposals = 10000;
+    BaseMaps baseMaps;
+    computeBaseMaps(input, baseMaps);
+
+    RNG rng(1);
+    proposal* props = random_proposals(input.size(), numProposals, rng);
+    vector<double> reference(numProposals * NUM_BASE_MAPS), means(numProposals * NUM_BASE_MAPS);
+
+    double t = (double)getTickCount();
+    for (int it = 0; it < iterations; it++)
+    {
+        for (int p = 0; p < numProposals; p++)
+        {
+            for (int i = 0; i < NUM_BASE_MAPS; i++)
+            {
+                reference[p * NUM_BASE_MAPS + i] = mean(baseMaps.maps[i](props[p].bbox))[0];
+            }
+        }
+    }
+    double tMean = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+    const Mat* maps[NUM_BASE_MAPS];
+    for (int i = 0; i < NUM_BASE_MAPS; i++)
+    {
+        maps[i] = &baseMaps.maps[i];
+    }
+    vector<double> ring(NUM_BASE_MAPS);
+    t = (double)getTickCount();
+    for (int it = 0; it < iterations; it++)
+    {
+        Mat table;
+        multiChannelIntegral(maps, NUM_BASE_MAPS, table);
+        for (int p = 0; p < numProposals; p++)
+        {
+            boxMeans(table, input.size(), props[p], &means[p * NUM_BASE_MAPS], &ring[0]);
+        }
+    }
+    double tTable = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+    double maxDiff = 0;
+    for (size_t i = 0; i < means.size(); i++)
+    {
+        maxDiff = std::max(maxDiff, std::abs(means[i] - reference[i]));
+    }
+
+    cout << numProposals << " proposals, " << NUM_BASE_MAPS << " maps" << endl;
+    cout << "cv::mean per box : " << tMean * 1000 << " ms" << endl;
+    cout << "summed-area table: " << tTable * 1000 << " ms (" << tMean / tTable << "x)" << endl;
+    cout << "max |diff|       : " << maxDiff << endl;
+    delete[] props;
+    return (maxDiff > 1e-4) ? 1 : 0;
+}
+
+/**
+* Times the selection of the 10 best of 100000 random proposals and of the
+* first proposal above a threshold (the score of the proposal at 3/4 of the
+* list, so the scan stops there or before), on one saliency map. The serial
+* reference scores every proposal in order and sorts; topKProposals and
+* firstProposalAbove run with 1, 2, 4, 8 and 16 threads and must return the
+* same proposals.
+*
+* @param  input      BGR image
+* @param  iterations number of timed runs for each version
+* @return            0 if every thread count agrees with the serial scan
+*/
+int benchmark_topk(Mat& input, int iterations)
+{
+    const int numProposals = 100000, k = 10;
+    float features[11];
+    std::fill(features, features + 11, 1.0f / 11);
+
+    BaseMaps baseMaps;
+    computeBaseMaps(input, baseMaps);
+    Mat saliencyMap, integralMap;
+    combineBaseMaps(baseMaps, features, NUM_BASE_MAPS, true, saliencyMap);
+    saliencyIntegral(saliencyMap, integralMap);
+
+    RNG rng(1);
+    proposal* props = random_proposals(input.size(), numProposals, rng);
+
+    // serial reference
+    vector< pair<int, int> > ranked(numProposals);
+    int firstAbove = -1;
+    double t = (double)getTickCount();
+    for (int it = 0; it < iterations; it++)
+    {
+        for (int i = 0; i < numProposals; i++)
+        {
+            ranked[i] = make_pair(-mapSaliencyScore(integralMap, input.size(), props[i]), i);
+        }
+        partial_sort(ranked.begin(), ranked.begin() + k, ranked.end());
+    }
+    double tSerial = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+    int thresh = mapSaliencyScore(integralMap, input.size(), props[3 * numProposals / 4]) - 1;
+    for (int i = 0; i < numProposals && firstAbove < 0; i++)
+    {
+        if (mapSaliencyScore(integralMap, input.size(), props[i]) > thresh)
+        {
+            firstAbove = i;
+        }
+    }
+
+    cout << numProposals << " proposals, top " << k << ", first above at " << firstAbove << endl;
+    cout << "serial scan  : " << tSerial * 1000 << " ms" << endl;
+
+    int status = 0;
+    int numThreads[5] = {1, 2, 4, 8, 16};
+    int defaultThreads = getNumThreads();
+    for (int n = 0; n < 5; n++)
+    {
+        setNumThreads(numThreads[n]);
+        int top[k];
+
+        t = (double)getTickCount();
+        for (int it = 0; it < iterations; it++)
+        {
+            topKProposals(integralMap, input.size(), props, numProposals, k, top);
+        }
+        double tTop = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+        t = (double)getTickCount();
+        int first = -1;
+        for (int it = 0; it < iterations; it++)
+        {
+            first = firstProposalAbove(integralMap, input.size(), props, numProposals, thresh);
+        }
+        double tFirst = ((double)getTickCount() - t) / getTickFrequency() / iterations;
+
+        bool same = (first == firstAbove);
+        for (int i = 0; i < k; i++)
+        {
+            same = same && (top[i] == ranked[i].second);
+        }
+        status |= same ? 0 : 1;
+
+        cout << numThreads[n] << " threads" << (numThreads[n] < 10 ? " " : "") << " : top-k "
+             << tTop * 1000 << " ms, first above " << tFirst * 1000 << " ms"
+             << (same ? "" : "  MISMATCH") << endl;
+    }
+    setNumThreads(defaultThreads);
+
+    delete[] props;
+    return status;
+}
+
+/**
+* Reports the peak memory of computing one saliency map with and without
+* options.lowMemory. The peak of a process never goes down, so each mode runs
+* in a child process of its own; the baseline is the peak after reading the
+* image.
+*
+* @param  input BGR image
+* @return       0 if both children ran
+*/
+int benchmark_memory(Mat& input)
+{
+    float features[11];
+    std::fill(features, features + 11, 1.0f / 11);
+    long baseline = peak_memory_kb();
+
+    cout << "Image " << input.cols << "x" << input.rows << ", baseline peak " << baseline << " kB" << endl;
+
+    int status = 0;
+    for (int lowMemory = 0; lowMemory <= 1; lowMemory++)
+    {
+        cout.flush();
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            SaliencyOptions options;
+            options.lowMemory = lowMemory;
+            generateSaliencyProto(input, features, true, false, options);
+
+            long peak = peak_memory_kb();
+            cout << (lowMemory ? "low memory mode : " : "default mode    : ") << peak << " kB peak, "
+                 << peak - baseline << " kB above baseline" << endl;
+            exit(0);
+        }
+
+        int childStatus = 1;
+        if (pid < 0 || waitpid(pid, &childStatus, 0) < 0 || childStatus != 0)
+        {
+            status = 1;
+        }
+    }
+    return status;
+}
+
+/**
+* Spearman rank correlation of two equally long lists of scores (ties get
+* their average rank).
+*/
+double rank_correlation(const vector<double>& a, const vector<double>& b)
+{
+    int n = (int) a.size();
+    if (n < 2)
+    {
+        return 1.0;
+    }
+
+    vector<double> rank[2];
+    const vector<double>* scores[2] = {&a, &b};
+    for (int s = 0; s < 2; s++)
+    {
+        vector< pair<double, int> > sorted(n);
+        for (int i = 0; i < n; i++)
+        {
+            sorted[i] = make_pair((*scores[s])[i], i);
+        }
+        sort(sorted.begin(), sorted.end());
+
+        rank[s].resize(n);
+        for (int i = 0; i < n; )
+        {
+            int j = i;
+            while (j + 1 < n && sorted[j + 1].first == sorted[i].first)
+            {
+                j++;
+            }
+            for (int k = i; k <= j; k++)
+            {
+                rank[s][sorted[k].second] = (i + j) / 2.0;
+            }
+            i = j + 1;
+        }
+    }
+
+    double mean = (n - 1) / 2.0;
+    double cov = 0, varA = 0, varB = 0;
+    for (int i = 0; i < n; i++)
+    {
+        cov  += (rank[0][i] - mean) * (rank[1][i] - mean);
+        varA += (rank[0][i] - mean) * (rank[0][i] - mean);
+        varB += (rank[1][i] - mean) * (rank[1][i] - mean);
+    }
+    return (varA > 0 && varB > 0) ? cov / sqrt(varA * varB) : 1.0;
+}
+
+/**
+* Names (without extension) of the .jpg images of a dataset class, sorted.
+*
+* @param  imagePath image folder of the class
+* @param  names     output, the names
+* @return           false if the folder could not be read
+*/
+static bool dataset_images(const string& imagePath, vector<string>& names)
+{
+    DIR *dir = opendir(imagePath.c_str());
+    if (dir == NULL)
+    {
+        perror(imagePath.c_str());
+        return false;
+    }
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL)
+    {
+        string name = ent -> d_name;
+        if (name.size() > 4 && name.substr(name.size() - 4) == ".jpg")
+        {
+            names.push_back(name.substr(0, name.size() - 4));
+        }
+    }
+    closedir(dir);
+    sort(names.begin(), names.end());
+    return true;
+}
+
+/**
+* Reads the proposals of one image of the dataset.
+*
+* @param  csvPath      proposal file
+* @param  propList     buffer of NUM_PROPOSALS rows for the file
+* @param  numProposals output, number of proposals
+* @return              the proposals (delete[] after use)
+*/
+static proposal* read_proposals(const string& csvPath, int propList[][5], int& numProposals)
+{
+    for (int i = 0; i < NUM_PROPOSALS; i++)
+    {
+        propList[i][2] = 0;
+    }
+    csvToProposalList(csvPath.c_str(), propList);
+    numProposals = 0;
+    while (numProposals < NUM_PROPOSALS && propList[numProposals][2] > 0)
+    {
+        numProposals++;
+    }
+    return arrayToProposals(propList, numProposals, 1);
+}
+
+/**
+* Runs generateSaliencyProto with two option sets on the images of one class
+* of the 4Progress dataset and compares the proposal rankings they produce.
+* Features are learned once from image/positive with the reference options;
+* every image with a proposal file in bboxes/ is scored with both maps (at
+* the scale of each map, as topPropoal does). Reports the mean saliency
+* time, the mean Spearman correlation of the proposal scores, how often the
+* top proposal is the same and the mean IoU of the two top proposals.
+*
+* @param  classDir   class folder (containing image/, image/positive, bboxes/)
+* @param  reference  options the candidate is compared against
+* @param  candidate  options under test
+* @param  maxImages  number of images to use, 0 for all
+* @return            0, 1 if the folder could not be read
+*/
+int report_dataset(const string& classDir, const SaliencyOptions& reference,
+                   const SaliencyOptions& candidate, int maxImages)
+{
+    string imagePath = classDir + "/image";
+    vector<string> names;
+    if (!dataset_images(imagePath, names))
+    {
+        return 1;
+    }
+
+    string trainPath = imagePath + "/positive";
+    float* features = learnFeaturefromDataset(trainPath.c_str(), 11, reference);
+
+    const SaliencyOptions* options[2] = {&reference, &candidate};
+    int (*propList)[5] = new int[NUM_PROPOSALS][5];
+    double time[2] = {0, 0};
+    double correlation = 0, iou = 0;
+    int numImages = 0, sameTop = 0;
+
+    for (size_t n = 0; n < names.size() && (maxImages <= 0 || numImages < maxImages); n++)
+    {
+        string csvPath = classDir + "/bboxes/" + names[n] + ".csv";
+        if (!ifstream(csvPath.c_str()).good())
+        {
+            continue;
+        }
+        Mat input = imread(imagePath + "/" + names[n] + ".jpg", CV_LOAD_IMAGE_COLOR);
+        if (input.empty())
+        {
+            continue;
+        }
+
+        int numProposals;
+        proposal* objProps = read_proposals(csvPath, propList, numProposals);
+
+        vector<double> scores[2];
+        int top[2] = {0, 0};
+        for (int s = 0; s < 2; s++)
+        {
+            double t = (double)getTickCount();
+            Mat saliencyMap = generateSaliencyProto(input, features, true, false, *options[s]);
+            time[s] += ((double)getTickCount() - t) / getTickFrequency();
+
+            Mat integralMap;
+            saliencyIntegral(saliencyMap, integralMap);
+            scores[s].resize(numProposals);
+            for (int i = 0; i < numProposals; i++)
+            {
+                scores[s][i] = mapSaliencyScore(integralMap, input.size(), objProps[i]);
+                if (scores[s][i] > scores[s][top[s]])
+                {
+                    top[s] = i;
+                }
+            }
+        }
+
+        if (numProposals > 0)
+        {
+            correlation += rank_correlation(scores[0], scores[1]);
+            iou += calculateIOU(objProps[top[0]].bbox, objProps[top[1]].bbox);
+            sameTop += (top[0] == top[1]) ? 1 : 0;
+        }
+        numImages++;
+        delete[] objProps;
+    }
+
+    delete[] propList;
+    delete[] features;
+
+    if (numImages == 0)
+    {
+        cout << "No images with proposals in " << classDir << endl;
+        return 1;
+    }
+
+    cout << numImages << " images" << endl;
+    cout << "reference           : " << time[0] / numImages * 1000 << " ms" << endl;
+    cout << "candidate           : " << time[1] / numImages * 1000 << " ms" << endl;
+    cout << "speedup             : " << time[0] / time[1] << "x" << endl;
+    cout << "rank correlation    : " << correlation / numImages << endl;
+    cout << "same top proposal   : " << 100.0 * sameTop / numImages << " %" << endl;
+    cout << "top proposal IoU    : " << iou / numImages << endl;
+    return 0;
+}
+
+/**
+* Compares the pipeline started at pyramid levels 1 and 2 with the full
+* resolution pipeline on one class of the dataset.
+*
+* @param  classDir  class folder of the 4Progress dataset
+* @param  maxImages number of images to use, 0 for all
+* @return           0 if every report ran
+*/
+int benchmark_startscale(const string& classDir, int maxImages)
+{
+    SaliencyOptions reference;
+    int status = 0;
+
+    for (int startScale = 1; startScale <= 2; startScale++)
+    {
+        SaliencyOptions candidate = reference;
+        candidate.startScale = startScale;
+
+        cout << "--- start scale " << startScale << " against full resolution ---" << endl;
+        status |= report_dataset(classDir, reference, candidate, maxImages);
+    }
+    return status;
+}
+
+/**
+* Compares the fast and fastest resampling tiers with the exact pyramids on
+* one class of the dataset.
+*
+* @param  classDir  class folder of the 4Progress dataset
+* @param  maxImages number of images to use, 0 for all
+* @return           0 if every report ran
+*/
+int benchmark_resampling(const string& classDir, int maxImages)
+{
+    const char* names[2] = {"fast", "fastest"};
+    const Resampling tiers[2] = {RESAMPLE_FAST, RESAMPLE_FASTEST};
+    SaliencyOptions reference;
+    int status = 0;
+
+    for (int i = 0; i < 2; i++)
+    {
+        SaliencyOptions candidate = reference;
+        candidate.resampling = tiers[i];
+
+        cout << "--- " << names[i] << " against exact ---" << endl;
+        status |= report_dataset(classDir, reference, candidate, maxImages);
+    }
+    return status;
+}
+
+/**
+* Compares the box mean center-surround engine with the pyramid engine on
+* one class of the dataset, with orientations filtered at full resolution
+* and on the intensity pyramid (where only the orientations stay on
+* pyramids).
+*
+* @param  classDir  class folder of the 4Progress dataset
+* @param  maxImages number of images to use, 0 for all
+* @return           0 if every report ran
+*/
+int benchmark_boxdog(const string& classDir, int maxImages)
+{
+    int status = 0;
+
+    for (int onPyramid = 0; onPyramid <= 1; onPyramid++)
+    {
+        SaliencyOptions reference;
+        reference.orientationOnPyramid = onPyramid;
+        SaliencyOptions candidate = reference;
+        candidate.boxCenterSurround = true;
+
+        cout << "--- box center-surround against pyramids"
+             << (onPyramid ? ", orientations on the pyramid" : "") << " ---" << endl;
+        status |= report_dataset(classDir, reference, candidate, maxImages);
+    }
+    return status;
+}
+
+/**
+* Compares base maps kept at the size of the conspicuity maps with base maps
+* at the size of the image on one class of the dataset.
+*
+* @param  classDir  class folder of the 4Progress dataset
+* @param  maxImages number of images to use, 0 for all
+* @return           0 if the report ran
+*/
+int benchmark_coarse(const string& classDir, int maxImages)
+{
+    SaliencyOptions reference;
+    SaliencyOptions candidate = reference;
+    candidate.coarseMaps = true;
+
+    cout << "--- coarse base maps against full size ---" << endl;
+    return report_dataset(classDir, reference, candidate, maxImages);
+}
+
+/**
+* Compares the coarse-to-fine cascade (see cascadeTopProposals) with
+* exhaustive scoring (topKProposals) on one class of the dataset, for
+* several survival ratios and adaptive bounds. The saliency map of each
+* image and its summed-area table are computed once; only the proposal
+* scoring is timed, the cascade including its coarse table. Reports the exhaustive
+* baseline time and per configuration the scoring time, its speedup over the
+* baseline (flagged below minSpeedup, where the cascade does not pay for its
+* winner changes), the fraction of proposals that survive, how often the
+* winner differs from the exhaustive one and the mean score it loses.
+*
+* @param  classDir  class folder of the 4Progress dataset
+* @param  maxImages number of images to use, 0 for all
+* @return           0, 1 if the folder could not be read
+*/
+int benchmark_cascade(const string& classDir, int maxImages)
+{
+    const int numConfigs = 7;
+    const double minSpeedup = 1.5;
+    const double ratios[4] = {0.02, 0.05, 0.1, 0.2};
+    const double sigmas[3] = {0.5, 1.0, 2.0};
+    CascadeOptions configs[numConfigs];
+    for (int c = 0; c < numConfigs; c++)
+    {
+        if (c < 4)
+        {
+            configs[c].rule = CASCADE_TOP_FRACTION;
+            configs[c].survivalRatio = ratios[c];
+        } else
+        {
+            configs[c].rule = CASCADE_ABOVE_BOUND;
+            configs[c].boundSigmas = sigmas[c - 4];
+        }
+    }
+
+    string imagePath = classDir + "/image";
+    vector<string> names;
+    if (!dataset_images(imagePath, names))
+    {
+        return 1;
+    }
+
+    string trainPath = imagePath + "/positive";
+    float* features = learnFeaturefromDataset(trainPath.c_str(), 11);
+
+    int (*propList)[5] = new int[NUM_PROPOSALS][5];
+    double exhaustiveTime = 0;
+    double time[numConfigs] = {0};
+    CascadeStats stats[numConfigs];
+    int numImages = 0;
+
+    for (size_t n = 0; n < names.size() && (maxImages <= 0 || numImages < maxImages); n++)
+    {
+        string csvPath = classDir + "/bboxes/" + names[n] + ".csv";
+        if (!ifstream(csvPath.c_str()).good())
+        {
+            continue;
+        }
+        Mat input = imread(imagePath + "/" + names[n] + ".jpg", CV_LOAD_IMAGE_COLOR);
+        if (input.empty())
+        {
+            continue;
+        }
+
+        int numProposals;
+        proposal* objProps = read_proposals(csvPath, propList, numProposals);
+        Mat saliencyMap = generateSaliencyProto(input, features, true, false);
+        Mat integralMap;
+        saliencyIntegral(saliencyMap, integralMap);
+        int top;
+
+        double t = (double)getTickCount();
+        topKProposals(integralMap, input.size(), objProps, numProposals, 1, &top);
+        exhaustiveTime += ((double)getTickCount() - t) / getTickFrequency();
+
+        for (int c = 0; c < numConfigs; c++)
+        {
+            t = (double)getTickCount();
+            cascadeTopProposals(integralMap, input.size(), objProps, numProposals, 1, &top, configs[c]);
+            time[c] += ((double)getTickCount() - t) / getTickFrequency();
+
+            CascadeOptions compare = configs[c];
+            compare.compareExhaustive = true;
+            cascadeTopProposals(integralMap, input.size(), objProps, numProposals, 1, &top, compare, &stats[c]);
+        }
+        numImages++;
+        delete[] objProps;
+    }
+
+    delete[] propList;
+    delete[] features;
+
+    if (numImages == 0)
+    {
+        cout << "No images with proposals in " << classDir << endl;
+        return 1;
+    }
+
+    cout << numImages << " images" << endl;
+    cout << "exhaustive baseline : " << exhaustiveTime / numImages * 1000 << " ms" << endl;
+    for (int c = 0; c < numConfigs; c++)
+    {
+        if (configs[c].rule == CASCADE_TOP_FRACTION)
+        {
+            cout << "--- top " << configs[c].survivalRatio * 100 << " % ---" << endl;
+        } else
+        {
+            cout << "--- above mean + " << configs[c].boundSigmas << " sigma ---" << endl;
+        }
+        double speedup = exhaustiveTime / time[c];
+        cout << "exhaustive baseline : " << exhaustiveTime / numImages * 1000 << " ms" << endl;
+        cout << "cascade             : " << time[c] / numImages * 1000 << " ms" << endl;
+        cout << "speedup             : " << speedup << "x";
+        if (speedup < minSpeedup)
+        {
+            cout << " (below " << minSpeedup << "x, exhaustive is preferable)";
+        }
+        cout << endl;
+        cout << "survivors           : "
+             << (stats[c].proposals > 0 ? 100.0 * stats[c].survivors / stats[c].proposals : 0) << " %" << endl;
+        cout << "winner changed      : " << 100.0 * stats[c].winnerChanges / stats[c].compared << " %" << endl;
+        cout << "mean score loss     : " << (double) stats[c].scoreLoss / stats[c].compared << endl;
+    }
+    return 0;
+}
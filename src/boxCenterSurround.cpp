@@ -0,0 +1,175 @@
+#include "boxCenterSurround.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+using namespace cv;
+
+template <class Scales>
+BoxCenterSurroundEngine<Scales>::BoxCenterSurroundEngine() : inputLevel(-1)
+{
+}
+
+/**
+* Table bounds of the boxes of one side centered on the output pixels of one
+* dimension, clipped to the image.
+*
+* @param numOut number of output pixels
+* @param cell   input pixels per output pixel
+* @param side   side of the box in input pixels
+* @param limit  input pixels (the table has limit + 1 entries)
+* @param start  output, first table index of each box
+* @param end    output, one past the last table index of each box
+*/
+static void box_bounds(int numOut, int cell, int side, int limit, vector<int>& start, vector<int>& end)
+{
+    start.resize(numOut);
+    end.resize(numOut);
+    for (int x = 0; x < numOut; ++x)
+    {
+        int lo = x*cell + (cell - side)/2;
+        start[x] = std::max(lo, 0);
+        end[x] = std::min(lo + side, limit);
+    }
+}
+
+/**
+* Mean of a box of a summed-area table.
+*
+* @param top    table row of the first row of the box
+* @param bottom table row one past the last row of the box
+* @param x0     first table column of the box
+* @param x1     table column one past the last column of the box
+* @param rows   number of rows of the box
+*/
+static inline double box_mean(const double* top, const double* bottom, int x0, int x1, int rows)
+{
+    return (bottom[x1] - top[x1] - bottom[x0] + top[x0]) / ((double) rows * (x1 - x0));
+}
+
+/**
+* Computes the output size and the boxes of every level for channels of a
+* size at a pyramid level (only when they change).
+*
+* @param size  size of the channel
+* @param level pyramid level of the channel (at most cL)
+*/
+template <class Scales>
+void BoxCenterSurroundEngine<Scales>::set_geometry(Size size, int level)
+{
+    CV_Assert(level >= 0 && level <= Scales::cL);
+    if (size == inputSize && level == inputLevel)
+    {
+        return;
+    }
+    inputSize = size;
+    inputLevel = level;
+
+    // the size of level cU, as Pyramid::level_size computes it
+    outSize = size;
+    for (int i = level; i < Scales::cU; ++i)
+    {
+        outSize = Size(outSize.width / 2, outSize.height / 2);
+    }
+
+    int cell = 1 << (Scales::cU - level);
+    for (int L = Scales::cL; L <= Scales::cU + Scales::sU; ++L)
+    {
+        int side = 1 << (L - level);
+        box_bounds(outSize.width, cell, side, size.width, colStart[L], colEnd[L]);
+        box_bounds(outSize.height, cell, side, size.height, rowStart[L], rowEnd[L]);
+    }
+}
+
+/**
+* Writes |center + sign * surround| of every center-surround pair, from the
+* summed-area table of the current channel.
+*
+* @param outPyr output maps (numMaps, reused when already allocated)
+* @param sign   -1 for a difference, +1 for an opponency (see opponency_diff)
+*/
+template <class Scales>
+void BoxCenterSurroundEngine<Scales>::box_diff(Mat* outPyr, double sign)
+{
+    const int numSurrounds = Scales::numSurrounds;
+
+    for (int c = Scales::cL; c <= Scales::cU; ++c)
+    {
+        Mat* out = outPyr + (c - Scales::cL) * numSurrounds;
+        for (int s = 0; s < numSurrounds; ++s)
+        {
+            out[s].create(outSize, CV_32F);
+        }
+
+        for (int y = 0; y < outSize.height; ++y)
+        {
+            const double* cTop = table.ptr<double>(rowStart[c][y]);
+            const double* cBottom = table.ptr<double>(rowEnd[c][y]);
+            int cRows = rowEnd[c][y] - rowStart[c][y];
+
+            const double* sTop[numSurrounds];
+            const double* sBottom[numSurrounds];
+            int sRows[numSurrounds];
+            float* o[numSurrounds];
+            for (int s = 0; s < numSurrounds; ++s)
+            {
+                int L = c + Scales::sL + s;
+                sTop[s] = table.ptr<double>(rowStart[L][y]);
+                sBottom[s] = table.ptr<double>(rowEnd[L][y]);
+                sRows[s] = rowEnd[L][y] - rowStart[L][y];
+                o[s] = out[s].ptr<float>(y);
+            }
+
+            for (int x = 0; x < outSize.width; ++x)
+            {
+                double center = box_mean(cTop, cBottom, colStart[c][x], colEnd[c][x], cRows);
+                for (int s = 0; s < numSurrounds; ++s)
+                {
+                    int L = c + Scales::sL + s;
+                    double surround = box_mean(sTop[s], sBottom[s], colStart[L][x], colEnd[L][x], sRows[s]);
+                    o[s][x] = (float) std::fabs(center + sign * surround);
+                }
+            }
+        }
+    }
+}
+
+/**
+* Center-surround differences of a channel, the box form of
+* CenterSurroundEngine::diff.
+*
+* @param input      channel (CV_32F)
+* @param inputLevel pyramid level of the channel (0 for full resolution)
+* @param outPyr     output maps, reused when already allocated
+*/
+template <class Scales>
+void BoxCenterSurroundEngine<Scales>::diff(const Mat& input, int inputLevel, Mat* outPyr)
+{
+    set_geometry(input.size(), inputLevel);
+    integral(input, table, CV_64F);
+    box_diff(outPyr, -1);
+}
+
+/**
+* Center-surround differences of a color opponency, the box form of
+* CenterSurroundEngine::opponency_diff: |(1 - 2)_c - (2 - 1)_s|, which is
+* |D_c + D_s| for D = 1 - 2, so only D gets a table.
+*
+* @param input1     first color (CV_32F)
+* @param input2     second color, same size
+* @param inputLevel pyramid level of the channels (0 for full resolution)
+* @param outPyr     output maps, reused when already allocated
+*/
+template <class Scales>
+void BoxCenterSurroundEngine<Scales>::opponency_diff(const Mat& input1, const Mat& input2, int inputLevel,
+                                                     Mat* outPyr)
+{
+    CV_Assert(input1.size() == input2.size());
+    set_geometry(input1.size(), inputLevel);
+    subtract(input1, input2, opponency);
+    integral(opponency, table, CV_64F);
+    box_diff(outPyr, 1);
+}
+
+template class BoxCenterSurroundEngine<IttiScales>;
+template class BoxCenterSurroundEngine<SevenLevelScales>;
@@ -0,0 +1,58 @@
+/**
+* Center-surround engine on box means of one summed-area table per channel,
+* an alternative to the pyramid based CenterSurroundEngine.
+*
+* A pixel of pyramid level L stands for a 2^L x 2^L block of the full
+* resolution image, so the center (level c) and surround (level c+s)
+* responses at an output pixel are taken as the means over boxes of those
+* sides centered on it. Every box mean is 4 reads of the summed-area table,
+* whatever its size, and no pyramid is built. The outputs are the numMaps
+* CV_32F maps at the size of level cU in the order CenterSurroundEngine
+* writes them, so normalization and integration do not change. Boxes are
+* clipped at the image border (mean over the part inside).
+*
+* The pyramid engine takes the difference at scale c and decimates it to
+* cU; here every output pixel is one sample of the difference at its center,
+* so the maps of the finer centers are not low-pass filtered. Opponencies
+* are linear in the difference of the two channels (see opponency_diff), so
+* they need a single table too.
+*/
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <vector>
+#include "scales.h"
+
+#ifndef BOX_CENTER_SURROUND_H
+#define BOX_CENTER_SURROUND_H
+
+template <class Scales>
+class BoxCenterSurroundEngine
+{
+public:
+    enum { numLevels = Scales::numLevels, numMaps = Scales::numMaps };
+
+    BoxCenterSurroundEngine();
+
+    void diff(const cv::Mat&, int, cv::Mat*);
+    void opponency_diff(const cv::Mat&, const cv::Mat&, int, cv::Mat*);
+
+private:
+    void set_geometry(cv::Size, int);
+    void box_diff(cv::Mat*, double);
+
+    cv::Mat table;          // summed-area table (CV_64F) of the channel
+    cv::Mat opponency;      // difference of the two opponent channels
+    cv::Size inputSize;     // geometry the boxes below were computed for
+    int inputLevel;
+    cv::Size outSize;       // size of level cU
+
+    // box of level L around output column x: table columns
+    // [colStart[L][x], colEnd[L][x]), the same for the rows
+    std::vector<int> colStart[numLevels], colEnd[numLevels];
+    std::vector<int> rowStart[numLevels], rowEnd[numLevels];
+};
+
+typedef BoxCenterSurroundEngine<SaliencyScales> BoxCenterSurround;
+
+#endif
@@ -0,0 +1,211 @@
+#include "centerSurround.h"
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+using namespace cv;
+
+template <class Scales>
+CenterSurroundEngine<Scales>::CenterSurroundEngine() : fixedScale(0), resampling(RESAMPLE_EXACT)
+{
+}
+
+/**
+* Marks all upsampled levels as not computed (buffers are kept).
+*
+* @param inPyr      (first) pyramid being processed
+* @param resampling resampling tier of the call
+*/
+template <class Scales>
+void CenterSurroundEngine<Scales>::reset(Pyramid& inPyr, Resampling resampling)
+{
+    CV_Assert(inPyr.levels() >= numLevels);
+    fixedScale = inPyr.fixed_scale();
+    this->resampling = resampling;
+    std::fill(done1, done1 + numLevels * numLevels, false);
+    std::fill(done2, done2 + numLevels * numLevels, false);
+}
+
+/**
+* Level L of a pyramid upsampled to the size of level t (t <= L) of the
+* reference pyramid, computed from level L upsampled to level t+1 the first
+* time it is needed. The fast resampling tiers resize level L to level t in
+* a single bilinear step instead.
+*
+* @param inPyr   pyramid being upsampled
+* @param sizes   pyramid whose level sizes are the targets
+* @param memo    upsampled levels of inPyr
+* @param done    which entries of memo are computed
+* @param L       source level
+* @param t       target level
+* @return        the upsampled map
+*/
+template <class Scales>
+const Mat& CenterSurroundEngine<Scales>::surround(Pyramid& inPyr, Pyramid& sizes, Mat* memo,
+                                                  bool* done, int L, int t)
+{
+    if (t == L)
+    {
+        return inPyr[L];
+    }
+
+    int index = L*numLevels + t;
+    if (!done[index])
+    {
+        Size size(sizes[t].cols, sizes[t].rows);
+        if (resampling == RESAMPLE_EXACT)
+        {
+            const Mat& previous = surround(inPyr, sizes, memo, done, L, t+1);
+            pyrUp(previous, memo[index], size);
+        } else {
+            resize(inPyr[L], memo[index], size, 0, 0, INTER_LINEAR);
+        }
+        done[index] = true;
+    }
+    return memo[index];
+}
+
+/**
+* Brings a difference map at center scale c down to scale cU, where all
+* conspicuity maps are stored.
+*
+* @param diffMap difference at scale c (c < cU)
+* @param sizes   pyramid whose level sizes are the targets
+* @param c       center scale
+* @param out     output map at scale cU
+*/
+template <class Scales>
+void CenterSurroundEngine<Scales>::to_center_scale(Mat& diffMap, Pyramid& sizes, int c, Mat& out)
+{
+    Mat* current = &diffMap;
+    for (int level = c+1; level < Scales::cU; ++level)
+    {
+        pyramid_down(*current, downsampled[level], Size(sizes[level].cols, sizes[level].rows), resampling);
+        current = &downsampled[level];
+    }
+    pyramid_down(*current, out, Size(sizes[Scales::cU].cols, sizes[Scales::cU].rows), resampling);
+}
+
+/**
+* Output map of a difference computed on fixed point pyramids (see
+* Pyramid::build_fixed): the values scaled back, as CV_32F for the
+* normalization. Maps of float pyramids are already the output.
+*
+* @param target difference at scale cU
+* @param out    output map
+*/
+template <class Scales>
+void CenterSurroundEngine<Scales>::to_float(Mat& target, Mat& out)
+{
+    if (fixedScale > 0)
+    {
+        target.convertTo(out, CV_32F, 1.0 / fixedScale);
+    }
+}
+
+/**
+* Calculates the across scale difference between multiple layers of a pyramid
+* and outputs them into the output pyramid (numMaps maps at scale cU, CV_32F;
+* the differences of fixed point pyramids are computed in fixed point).
+*
+* @param inPyr      Input pyramid
+* @param outPyr     Output pyramid, reused when already allocated
+* @param resampling resampling tier (see Resampling)
+*/
+template <class Scales>
+void CenterSurroundEngine<Scales>::diff(Pyramid& inPyr, Mat* outPyr, Resampling resampling)
+{
+    reset(inPyr, resampling);
+    diff_center(inPyr, outPyr, ScaleLevel<Scales::cL>());
+}
+
+/**
+* The maps of center scale c, then (recursively) those of the coarser centers.
+*/
+template <class Scales>
+template <int c>
+void CenterSurroundEngine<Scales>::diff_center(Pyramid& inPyr, Mat* outPyr, ScaleLevel<c>)
+{
+    for (int s = Scales::sL; s <= Scales::sU; ++s)
+    {
+        Mat& out = outPyr[(c - Scales::cL) * Scales::numSurrounds + s - Scales::sL];
+        Mat& target = fixedScale > 0 ? fixedOut : out;
+        const Mat& temp = surround(inPyr, inPyr, surround1, done1, c+s, c);
+        if (c == Scales::cU)
+        {
+            absdiff(inPyr[c], temp, target);
+        } else {
+            absdiff(inPyr[c], temp, difference);
+            to_center_scale(difference, inPyr, c, target);
+        }
+        to_float(target, out);
+    }
+    diff_center(inPyr, outPyr, ScaleLevel<c + 1>());
+}
+
+/**
+* Calculates the across scale difference between multiple layers of a pyramid
+* for an color opponency featyre and outputs them into the output pyramid
+*
+* On fixed point pyramids the result |(1 - 2)_c - (2 - 1)_s| is up to twice
+* the largest level value, so both pyramids must lie in [0, 16383] (colors
+* in [0, 1] at a scale of at most 2^14-1) for it to fit in CV_16S without
+* saturating. That is checked on level cL: the coarser levels and the
+* upsampled surrounds are weighted averages of it and stay in its range.
+*
+* @param inPyr1     Input pyramid for first color
+* @param inPyr2     Input pyramid for second color
+* @param outPyr     Output pyramid, reused when already allocated
+* @param resampling resampling tier (see Resampling)
+*/
+template <class Scales>
+void CenterSurroundEngine<Scales>::opponency_diff(Pyramid& inPyr1, Pyramid& inPyr2, Mat* outPyr,
+                                                  Resampling resampling)
+{
+    CV_Assert(inPyr1.fixed_scale() == inPyr2.fixed_scale());
+    if (inPyr1.fixed_scale() > 0)
+    {
+        const int maxValue = SHRT_MAX / 2;
+        double min1, max1, min2, max2;
+        minMaxLoc(inPyr1[Scales::cL], &min1, &max1);
+        minMaxLoc(inPyr2[Scales::cL], &min2, &max2);
+        CV_Assert(min1 >= 0 && min2 >= 0 && max1 <= maxValue && max2 <= maxValue);
+    }
+    reset(inPyr1, resampling);
+    opponency_center(inPyr1, inPyr2, outPyr, ScaleLevel<Scales::cL>());
+}
+
+template <class Scales>
+template <int c>
+void CenterSurroundEngine<Scales>::opponency_center(Pyramid& inPyr1, Pyramid& inPyr2, Mat* outPyr,
+                                                    ScaleLevel<c>)
+{
+    // center opponency, shared by both surround offsets
+    subtract(inPyr1[c], inPyr2[c], centers[c]);
+
+    for (int s = Scales::sL; s <= Scales::sU; ++s)
+    {
+        Mat& out = outPyr[(c - Scales::cL) * Scales::numSurrounds + s - Scales::sL];
+
+        // scale both to information in first pyramid
+        // while both pyramids should be identical, this is a way to avoid
+        // potential errors and to enforce same dimensions for both
+        const Mat& temp1 = surround(inPyr1, inPyr1, surround1, done1, c+s, c);
+        const Mat& temp2 = surround(inPyr2, inPyr1, surround2, done2, c+s, c);
+        subtract(temp2, temp1, surroundDiff);
+
+        Mat& target = fixedScale > 0 ? fixedOut : out;
+        if (c == Scales::cU)
+        {
+            absdiff(centers[c], surroundDiff, target);
+        } else {
+            absdiff(centers[c], surroundDiff, difference);
+            to_center_scale(difference, inPyr1, c, target);
+        }
+        to_float(target, out);
+    }
+    opponency_center(inPyr1, inPyr2, outPyr, ScaleLevel<c + 1>());
+}
+
+template class CenterSurroundEngine<IttiScales>;
+template class CenterSurroundEngine<SevenLevelScales>;
@@ -0,0 +1,65 @@
+/**
+* Center-surround (across scale difference) engine.
+*
+* For center scales c in [cL, cU] and surround offsets s in [sL, sU] (see
+* ScaleConfig; [2, 4] and [3, 4] as defined in Itti's paper) the surround
+* level c+s is upsampled to the size of level c with a chain of pyrUp calls.
+* The chains of different (c, s) pairs overlap (e.g. level 6 upsampled to
+* level 3 is a step of level 6 upsampled to level 2), so every upsampled level
+* is computed once per pyramid and shared. All intermediate buffers belong to
+* the engine, are sized by the configuration and are reused across calls.
+* Fixed point pyramids (Pyramid::build_fixed) are processed in fixed point up
+* to the output maps, which are always CV_32F. The fast resampling tiers
+* (see Resampling) replace the pyrUp chains by one bilinear resize each.
+*
+* The engine is a template over the scale configuration: the loop over the
+* center scales is unrolled at compile time and the c == cU case (no
+* downsampling to the conspicuity scale) is resolved per center. The
+* definitions are in centerSurround.cpp, instantiated there for IttiScales
+* and SevenLevelScales; a new configuration needs one more instantiation.
+*/
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include "pyramid.h"
+#include "scales.h"
+
+#ifndef CENTER_SURROUND_H
+#define CENTER_SURROUND_H
+
+template <class Scales>
+class CenterSurroundEngine
+{
+public:
+    enum { numLevels = Scales::numLevels, numMaps = Scales::numMaps };
+
+    CenterSurroundEngine();
+
+    void diff(Pyramid&, cv::Mat*, Resampling = RESAMPLE_EXACT);
+    void opponency_diff(Pyramid&, Pyramid&, cv::Mat*, Resampling = RESAMPLE_EXACT);
+
+private:
+    template <int c> void diff_center(Pyramid&, cv::Mat*, ScaleLevel<c>);
+    void diff_center(Pyramid&, cv::Mat*, ScaleLevel<Scales::cU + 1>) {}
+    template <int c> void opponency_center(Pyramid&, Pyramid&, cv::Mat*, ScaleLevel<c>);
+    void opponency_center(Pyramid&, Pyramid&, cv::Mat*, ScaleLevel<Scales::cU + 1>) {}
+
+    const cv::Mat& surround(Pyramid&, Pyramid&, cv::Mat*, bool*, int, int);
+    void to_center_scale(cv::Mat&, Pyramid&, int, cv::Mat&);
+    void to_float(cv::Mat&, cv::Mat&);
+    void reset(Pyramid&, Resampling);
+
+    // level L upsampled to the size of level t is at [L*numLevels + t]
+    cv::Mat surround1[numLevels * numLevels], surround2[numLevels * numLevels];
+    bool done1[numLevels * numLevels], done2[numLevels * numLevels];
+    cv::Mat centers[numLevels];
+    cv::Mat downsampled[numLevels];
+    cv::Mat difference, surroundDiff;
+    cv::Mat fixedOut;       // fixed point output before the conversion
+    double fixedScale;      // of the pyramids being processed, 0 for float
+    Resampling resampling;  // tier of the current call
+};
+
+typedef CenterSurroundEngine<SaliencyScales> CenterSurround;
+
+#endif
@@ -0,0 +1,500 @@
+#include "gabor.h"
+
+using namespace std;
+using namespace cv;
+
+// singular values smaller than this fraction of the largest one are dropped
+// from the separable approximation
+static const double SEPARABLE_TOLERANCE = 1e-3;
+
+// rough per-element costs used to pick the cheapest method
+static const double FFT_COST      = 2.5;    // per element and log2(size) of a DFT
+static const double SPECTRUM_COST = 3.0;    // per element of a spectrum product
+
+bool GaborParams::operator<(const GaborParams& other) const
+{
+    if (kerSize.width  != other.kerSize.width)  return kerSize.width  < other.kerSize.width;
+    if (kerSize.height != other.kerSize.height) return kerSize.height < other.kerSize.height;
+    if (sigma  != other.sigma)  return sigma  < other.sigma;
+    if (lambda != other.lambda) return lambda < other.lambda;
+    if (gamma  != other.gamma)  return gamma  < other.gamma;
+    if (psi    != other.psi)    return psi    < other.psi;
+    return thetas < other.thetas;
+}
+
+/**
+* Builds the kernels of the bank and their separable decomposition.
+*
+* @param params Gabor parameters, one kernel per orientation
+*/
+GaborBank::GaborBank(const GaborParams& params) : parameters(params)
+{
+    for (size_t k = 0; k < params.thetas.size(); k++)
+    {
+        Mat kern = getGaborKernel(params.kerSize, params.sigma, params.thetas[k],
+                                  params.lambda, params.gamma, params.psi);
+        kernels.push_back(kern);
+
+        // kern = U * diag(w) * Vt, every singular value gives a separable term
+        Mat w, u, vt;
+        SVD::compute(kern, w, u, vt);
+
+        vector<Mat> rows, cols;
+        for (int i = 0; i < w.rows; i++)
+        {
+            if (w.at<double>(i) <= SEPARABLE_TOLERANCE * w.at<double>(0))
+            {
+                break;
+            }
+            Mat rowKern, colKern;
+            vt.row(i).convertTo(rowKern, CV_32F);
+            u.col(i).convertTo(colKern, CV_32F, w.at<double>(i));
+            rows.push_back(rowKern);
+            cols.push_back(colKern);
+        }
+        rowKernels.push_back(rows);
+        colKernels.push_back(cols);
+    }
+}
+
+int GaborBank::size() const
+{
+    return (int) kernels.size();
+}
+
+const Mat& GaborBank::kernel(int k) const
+{
+    return kernels[k];
+}
+
+const GaborParams& GaborBank::params() const
+{
+    return parameters;
+}
+
+/**
+* Estimates the cost of every method for an image size and returns the cheapest.
+*
+* @param  imageSize size of the image to be filtered
+* @return           DIRECT, SEPARABLE or FFT
+*/
+GaborBank::Method GaborBank::choose_method(Size imageSize) const
+{
+    double n = (double) imageSize.area();
+    double direct = 0, separable = 0;
+
+    for (int k = 0; k < size(); k++)
+    {
+        direct    += n * kernels[k].rows * kernels[k].cols;
+        separable += n * rowKernels[k].size() * (kernels[k].rows + kernels[k].cols + 1);
+    }
+
+    double m = (double) getOptimalDFTSize(imageSize.width + kernels[0].cols - 1)
+                      * getOptimalDFTSize(imageSize.height + kernels[0].rows - 1);
+    double fft = m * std::log(m) / std::log(2.0) * FFT_COST * (1 + size())
+                 + m * SPECTRUM_COST * size();
+
+    if (fft < direct && fft < separable)
+    {
+        return FFT;
+    }
+    return (separable < direct) ? SEPARABLE : DIRECT;
+}
+
+/**
+* Filters an image with every kernel of the bank. The output is the same as
+* filter2D(src, dst[k], CV_32F, kernel(k)): the FFT result differs by float
+* round-off only, the separable one by the dropped singular values.
+*
+* @param src    single channel input image
+* @param dst    array of size() output Mats (CV_32F), reused when possible
+* @param method how to filter, AUTO picks the cheapest for the image size
+*/
+void GaborBank::apply(const Mat& src, Mat* dst, Method method)
+{
+    if (method == AUTO)
+    {
+        method = choose_method(src.size());
+    }
+
+    switch (method)
+    {
+        case SEPARABLE: apply_separable(src, dst); break;
+        case FFT:       apply_fft(src, dst);       break;
+        default:        apply_direct(src, dst);    break;
+    }
+}
+
+void GaborBank::apply_direct(const Mat& src, Mat* dst)
+{
+    for (int k = 0; k < size(); k++)
+    {
+        filter2D(src, dst[k], CV_32F, kernels[k]);
+    }
+}
+
+void GaborBank::apply_separable(const Mat& src, Mat* dst)
+{
+    for (int k = 0; k < size(); k++)
+    {
+        sepFilter2D(src, dst[k], CV_32F, rowKernels[k][0], colKernels[k][0]);
+        for (size_t i = 1; i < rowKernels[k].size(); i++)
+        {
+            sepFilter2D(src, response, CV_32F, rowKernels[k][i], colKernels[k][i]);
+            add(dst[k], response, dst[k]);
+        }
+    }
+}
+
+/**
+* Filters rows [y0, y1) of an image with kernel k into the same rows of dst,
+* directly or separably, whichever is cheaper for the kernel (the FFT needs
+* the whole image). Rows outside the band are read as the border, as when
+* filtering the whole image, so the bands of an image give exactly
+* filter2D(src, dst, CV_32F, kernel(k)) for the direct method and the
+* SEPARABLE result otherwise. The bank is not modified: bands can be
+* filtered concurrently.
+*
+* @param src     single channel input image
+* @param k       kernel index
+* @param dst     output image (CV_32F, the size of src, allocated by the
+*                caller)
+* @param y0      first row
+* @param y1      one past the last row
+* @param scratch buffer for the separable terms after the first
+*/
+void GaborBank::apply_rows(const Mat& src, int k, Mat& dst, int y0, int y1, Mat& scratch) const
+{
+    Mat in = src.rowRange(y0, y1);
+    Mat out = dst.rowRange(y0, y1);
+
+    int terms = (int) rowKernels[k].size();
+    if (terms * (kernels[k].rows + kernels[k].cols + 1) >= kernels[k].rows * kernels[k].cols)
+    {
+        filter2D(in, out, CV_32F, kernels[k]);
+        return;
+    }
+
+    sepFilter2D(in, out, CV_32F, rowKernels[k][0], colKernels[k][0]);
+    for (int i = 1; i < terms; i++)
+    {
+        sepFilter2D(in, scratch, CV_32F, rowKernels[k][i], colKernels[k][i]);
+        add(out, scratch, out);
+    }
+}
+
+/**
+* The kernel spectra and FFT buffers for a DFT size, the spectra computed
+* the first time the size is used. Kernels are placed at the top-left corner
+* so the product with the conjugate spectrum gives the correlation filter2D
+* computes.
+*/
+GaborBank::DftBuffers& GaborBank::prepare_spectra(Size size)
+{
+    DftBuffers& buffers = dftBuffers[make_pair(size.width, size.height)];
+    if (!buffers.spectra.empty())
+    {
+        return buffers;
+    }
+
+    buffers.spectra.resize(kernels.size());
+    for (int k = 0; k < this->size(); k++)
+    {
+        Mat kern(size, CV_32F, Scalar(0.0));
+        Mat corner = kern(Rect(0, 0, kernels[k].cols, kernels[k].rows));
+        kernels[k].convertTo(corner, CV_32F);
+        dft(kern, buffers.spectra[k], 0, kernels[k].rows);
+    }
+    return buffers;
+}
+
+void GaborBank::apply_fft(const Mat& src, Mat* dst)
+{
+    int kw = kernels[0].cols, kh = kernels[0].rows;
+    int ax = kw / 2, ay = kh / 2;
+
+    Size paddedSize(src.cols + kw - 1, src.rows + kh - 1);
+    Size dftSize(getOptimalDFTSize(paddedSize.width), getOptimalDFTSize(paddedSize.height));
+    DftBuffers& b = prepare_spectra(dftSize);
+    Mat& padded = b.padded;
+
+    // image with the border filter2D would use, zero filled up to the DFT size
+    padded.create(dftSize, CV_32F);
+    padded.setTo(Scalar(0.0));
+    Mat border = padded(Rect(0, 0, paddedSize.width, paddedSize.height));
+    Mat src32 = src;
+    if (src.type() != CV_32F)
+    {
+        src.convertTo(src32, CV_32F);
+    }
+    copyMakeBorder(src32, border, ay, kh - 1 - ay, ax, kw - 1 - ax, BORDER_REFLECT_101);
+
+    dft(padded, b.imageSpectrum, 0, paddedSize.height);
+
+    for (int k = 0; k < size(); k++)
+    {
+        mulSpectrums(b.imageSpectrum, b.spectra[k], b.product, 0, true);
+        idft(b.product, b.response, DFT_SCALE | DFT_REAL_OUTPUT, src.rows);
+        b.response(Rect(0, 0, src.cols, src.rows)).copyTo(dst[k]);
+    }
+}
+
+
+/**
+* Builds a steerable filter from the basis kernels at angles j*pi/basisSize.
+*
+* @param params    Gabor parameters (thetas are ignored)
+* @param basisSize number of basis kernels
+*/
+SteerableGabor::SteerableGabor(const GaborParams& params, int basisSize)
+{
+    GaborParams basisParams = params;
+    basisParams.thetas.clear();
+    for (int j = 0; j < basisSize; j++)
+    {
+        basisParams.thetas.push_back(j * CV_PI / basisSize);
+    }
+    basis = &cached_gabor_bank(basisParams);
+
+    gram.create(basisSize, basisSize, CV_64F);
+    for (int i = 0; i < basisSize; i++)
+    {
+        for (int j = 0; j < basisSize; j++)
+        {
+            gram.at<double>(i, j) = basis->kernel(i).dot(basis->kernel(j));
+        }
+    }
+    responses.resize(basisSize);
+}
+
+int SteerableGabor::basis_size() const
+{
+    return basis->size();
+}
+
+/**
+* Least squares weights of the basis kernels for an orientation, computed
+* once per angle.
+*
+* @param  theta orientation in radians
+* @return       basis_size() x 1 weights (CV_64F)
+*/
+const Mat& SteerableGabor::coefficients(double theta)
+{
+    map<double, Mat>::iterator it = coefficientCache.find(theta);
+    if (it != coefficientCache.end())
+    {
+        return it->second;
+    }
+
+    const GaborParams& p = basis->params();
+    Mat target = getGaborKernel(p.kerSize, p.sigma, theta, p.lambda, p.gamma, p.psi);
+
+    Mat rhs(basis_size(), 1, CV_64F);
+    for (int j = 0; j < basis_size(); j++)
+    {
+        rhs.at<double>(j) = basis->kernel(j).dot(target);
+    }
+
+    Mat weights;
+    solve(gram, rhs, weights, DECOMP_SVD);
+    return coefficientCache[theta] = weights;
+}
+
+/**
+* The kernel for an orientation as synthesized from the basis: sum_j w_j K_j.
+* Filtering with it gives the steered response of steer (up to round-off).
+*
+* @param  theta orientation in radians
+* @return       steered kernel (CV_64F)
+*/
+Mat SteerableGabor::steered_kernel(double theta)
+{
+    const Mat& weights = coefficients(theta);
+
+    Mat steered = Mat::zeros(basis->kernel(0).rows, basis->kernel(0).cols, CV_64F);
+    for (int j = 0; j < basis_size(); j++)
+    {
+        scaleAdd(basis->kernel(j), weights.at<double>(j), steered, steered);
+    }
+    return steered;
+}
+
+/**
+* Relative error ||K(theta) - sum_j w_j K_j|| / ||K(theta)|| of the steered
+* kernel for an orientation.
+*/
+double SteerableGabor::steering_error(double theta)
+{
+    const GaborParams& p = basis->params();
+    Mat target = getGaborKernel(p.kerSize, p.sigma, theta, p.lambda, p.gamma, p.psi);
+    return norm(target, steered_kernel(theta)) / norm(target);
+}
+
+/**
+* Combines basis responses into the response for one orientation.
+*
+* @param basisResponses basis_size() filtered images (CV_32F)
+* @param theta          orientation in radians
+* @param dst            output image (CV_32F)
+*/
+void SteerableGabor::steer(const Mat* basisResponses, double theta, Mat& dst)
+{
+    coefficients(theta);
+    dst.create(basisResponses[0].rows, basisResponses[0].cols, CV_32F);
+    steer_rows(basisResponses, theta, dst, 0, dst.rows);
+}
+
+/**
+* Computes the basis weights of orientations ahead of steer_rows, which only
+* reads them.
+*
+* @param thetas orientations in radians
+*/
+void SteerableGabor::prepare(const vector<double>& thetas)
+{
+    for (size_t k = 0; k < thetas.size(); k++)
+    {
+        coefficients(thetas[k]);
+    }
+}
+
+/**
+* steer for rows [y0, y1) only. The weights of theta must have been computed
+* (prepare), so bands can be steered concurrently.
+*
+* @param basisResponses basis_size() filtered images (CV_32F), of which only
+*                       the rows of the band are read
+* @param theta          orientation in radians
+* @param dst            output image (CV_32F, allocated by the caller)
+* @param y0             first row
+* @param y1             one past the last row
+*/
+void SteerableGabor::steer_rows(const Mat* basisResponses, double theta, Mat& dst, int y0, int y1) const
+{
+    int n = basis_size();
+
+    // orientations in the basis are copied as they are
+    for (int j = 0; j < n; j++)
+    {
+        if (std::abs(basis->params().thetas[j] - theta) < 1e-12)
+        {
+            Mat band = dst.rowRange(y0, y1);
+            basisResponses[j].rowRange(y0, y1).copyTo(band);
+            return;
+        }
+    }
+
+    map<double, Mat>::const_iterator it = coefficientCache.find(theta);
+    CV_Assert(it != coefficientCache.end());
+    const double* w = it->second.ptr<double>();
+
+    for (int y = y0; y < y1; y++)
+    {
+        float* d_p = dst.ptr<float>(y);
+        const float* b_p = basisResponses[0].ptr<float>(y);
+        float w0 = (float) w[0];
+        for (int x = 0; x < dst.cols; x++)
+        {
+            d_p[x] = w0 * b_p[x];
+        }
+        for (int j = 1; j < n; j++)
+        {
+            b_p = basisResponses[j].ptr<float>(y);
+            float wj = (float) w[j];
+            for (int x = 0; x < dst.cols; x++)
+            {
+                d_p[x] += wj * b_p[x];
+            }
+        }
+    }
+}
+
+const GaborBank& SteerableGabor::basis_bank() const
+{
+    return *basis;
+}
+
+/**
+* Filters an image with the basis once and synthesizes every orientation.
+*
+* @param src    single channel input image
+* @param thetas orientations in radians
+* @param dst    array of thetas.size() output Mats (CV_32F)
+*/
+void SteerableGabor::apply(const Mat& src, const vector<double>& thetas, Mat* dst)
+{
+    basis->apply(src, &responses[0]);
+    for (size_t k = 0; k < thetas.size(); k++)
+    {
+        steer(&responses[0], thetas[k], dst[k]);
+    }
+}
+
+
+/**
+* Gabor parameters used by the saliency model: 4 orientations
+* (0, 45, 90 and 135 degrees) of an odd-phase filter.
+*/
+GaborParams itti_gabor_params()
+{
+    return itti_gabor_params(4);
+}
+
+/**
+* Gabor parameters used by the saliency model with numOrientations evenly
+* spaced orientations k*pi/numOrientations.
+*/
+GaborParams itti_gabor_params(int numOrientations)
+{
+    GaborParams params;
+    params.kerSize = Size(10, 10);
+    params.sigma   = 0.8;
+    params.lambda  = CV_PI;
+    params.gamma   = 1;
+    params.psi     = CV_PI / 2;
+
+    for (int k = 0; k < numOrientations; k++)
+    {
+        params.thetas.push_back(k * CV_PI / numOrientations);
+    }
+    return params;
+}
+
+/**
+* Returns the bank for a parameter set, building it on first use. Banks are
+* kept for the lifetime of the program.
+*
+* @param  params Gabor parameters
+* @return        a bank that can be reused across images
+*/
+GaborBank& cached_gabor_bank(const GaborParams& params)
+{
+    static map<GaborParams, GaborBank*> banks;
+
+    map<GaborParams, GaborBank*>::iterator it = banks.find(params);
+    if (it == banks.end())
+    {
+        it = banks.insert(make_pair(params, new GaborBank(params))).first;
+    }
+    return *(it->second);
+}
+
+/**
+* Returns the steerable filter with the saliency model's Gabor parameters for
+* a basis size, building it on first use.
+*
+* @param  basisSize number of basis kernels
+* @return           a steerable filter that can be reused across images
+*/
+SteerableGabor& cached_steerable_gabor(int basisSize)
+{
+    static map<int, SteerableGabor*> filters;
+
+    map<int, SteerableGabor*>::iterator it = filters.find(basisSize);
+    if (it == filters.end())
+    {
+        it = filters.insert(make_pair(basisSize, new SteerableGabor(itti_gabor_params(), basisSize))).first;
+    }
+    return *(it->second);
+}
@@ -0,0 +1,121 @@
+/**
+* Gabor filter banks for the orientation feature maps.
+*
+* A bank holds the kernels for one parameter set and filters an image with all
+* of them at once, using whichever of the following is cheapest for the image
+* size:
+*   DIRECT     one filter2D pass per kernel
+*   SEPARABLE  SVD of every kernel into a sum of separable (row x column) terms
+*   FFT        one forward DFT of the image shared by all kernels, followed by
+*              a pointwise product and an inverse DFT per kernel
+*
+* SteerableGabor convolves a fixed basis of Gabor kernels once and synthesizes
+* the response for any orientation as a linear combination of the basis
+* responses, so the number of orientations does not change the filtering cost.
+*/
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <map>
+
+#ifndef GABOR_H
+#define GABOR_H
+
+/**
+* Parameters of a Gabor filter bank (see cv::getGaborKernel). One kernel is
+* built for every orientation in thetas (radians).
+*/
+struct GaborParams
+{
+    cv::Size kerSize;
+    double sigma;
+    double lambda;
+    double gamma;
+    double psi;
+    std::vector<double> thetas;
+
+    bool operator<(const GaborParams&) const;
+};
+
+class GaborBank
+{
+public:
+    enum Method { AUTO, DIRECT, SEPARABLE, FFT };
+
+    explicit GaborBank(const GaborParams&);
+
+    void apply(const cv::Mat&, cv::Mat*, Method = AUTO);
+    void apply_rows(const cv::Mat&, int, cv::Mat&, int, int, cv::Mat&) const;
+    Method choose_method(cv::Size) const;
+
+    int size() const;
+    const cv::Mat& kernel(int) const;
+    const GaborParams& params() const;
+
+private:
+    void apply_direct(const cv::Mat&, cv::Mat*);
+    void apply_separable(const cv::Mat&, cv::Mat*);
+    void apply_fft(const cv::Mat&, cv::Mat*);
+    struct DftBuffers
+    {
+        std::vector<cv::Mat> spectra;   // of the kernels
+        cv::Mat padded, imageSpectrum, product, response;
+    };
+    DftBuffers& prepare_spectra(cv::Size);
+
+    GaborParams parameters;
+    std::vector<cv::Mat> kernels;
+
+    // separable terms of each kernel: kernel ~ sum_i colKernels[i] * rowKernels[i]
+    std::vector< std::vector<cv::Mat> > rowKernels;
+    std::vector< std::vector<cv::Mat> > colKernels;
+
+    // kernel spectra and FFT buffers for every DFT size used, by (width,
+    // height): filtering the levels of a pyramid in turn neither recomputes
+    // the spectra nor reallocates the buffers
+    std::map< std::pair<int, int>, DftBuffers > dftBuffers;
+    cv::Mat response;   // separable term
+};
+
+/**
+* Orientation responses synthesized from basis kernels at angles j*pi/B,
+* j = 0..B-1. The kernel for any angle is approximated (least squares) by a
+* combination of the basis kernels, so the response is the same combination of
+* the basis responses. Worst relative kernel error over all angles for the
+* saliency model's Gabor parameters:
+*   B = 4: 6%   B = 6: 0.7%   B = 8: 0.02%
+* Angles that are part of the basis are exact.
+*/
+class SteerableGabor
+{
+public:
+    SteerableGabor(const GaborParams&, int);
+
+    void apply(const cv::Mat&, const std::vector<double>&, cv::Mat*);
+    void steer(const cv::Mat*, double, cv::Mat&);
+    void prepare(const std::vector<double>&);
+    void steer_rows(const cv::Mat*, double, cv::Mat&, int, int) const;
+    const GaborBank& basis_bank() const;
+    cv::Mat steered_kernel(double);
+    double steering_error(double);
+    int basis_size() const;
+
+private:
+    const cv::Mat& coefficients(double);
+
+    GaborBank* basis;
+    cv::Mat gram;
+    std::map<double, cv::Mat> coefficientCache;
+    std::vector<cv::Mat> responses;
+};
+
+GaborParams itti_gabor_params();
+GaborParams itti_gabor_params(int);
+GaborBank& cached_gabor_bank(const GaborParams&);
+SteerableGabor& cached_steerable_gabor(int);
+
+#endif
@@ -1,8 +1,162 @@
 #include "normalize.h"
 
+#if defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
 using namespace cv;
 using namespace std;
 
+/**
+* Statistics the normalization operator needs, gathered in one sweep over a
+* map: its range and its local maxima (pixels not smaller than any of their 8
+* neighbours, the image border excluded).
+*/
+struct MapStatistics
+{
+    float minVal;
+    float maxVal;
+    int numLocalMax;
+    double sumLocalMax;
+    float maxLocalMax;
+};
+
+/**
+* Counts, sums and takes the largest of the local maxima among the pixels
+* [1, n) of row r1 (r0 and r2 are the rows above and below it). Returns the
+* first pixel left for the scalar loop. Lane sums are added up per call, so
+* the sum differs from a sequential one by float rounding only.
+*/
+#if defined(__AVX2__)
+static int local_maxima_row_simd(const float* r0, const float* r1, const float* r2, int n,
+                                 int& count, double& sum, float& maxVal)
+{
+    __m256 sumv = _mm256_setzero_ps();
+    __m256 maxv = _mm256_set1_ps(maxVal);
+    int j = 1;
+    for (; j + 8 <= n; j += 8)
+    {
+        __m256 c = _mm256_loadu_ps(r1 + j);
+        __m256 m = _mm256_and_ps(
+            _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(c, _mm256_loadu_ps(r0 + j - 1), _CMP_GE_OQ),
+                                        _mm256_cmp_ps(c, _mm256_loadu_ps(r0 + j), _CMP_GE_OQ)),
+                          _mm256_and_ps(_mm256_cmp_ps(c, _mm256_loadu_ps(r0 + j + 1), _CMP_GE_OQ),
+                                        _mm256_cmp_ps(c, _mm256_loadu_ps(r1 + j - 1), _CMP_GE_OQ))),
+            _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(c, _mm256_loadu_ps(r1 + j + 1), _CMP_GE_OQ),
+                                        _mm256_cmp_ps(c, _mm256_loadu_ps(r2 + j - 1), _CMP_GE_OQ)),
+                          _mm256_and_ps(_mm256_cmp_ps(c, _mm256_loadu_ps(r2 + j), _CMP_GE_OQ),
+                                        _mm256_cmp_ps(c, _mm256_loadu_ps(r2 + j + 1), _CMP_GE_OQ))));
+
+        count += __builtin_popcount(_mm256_movemask_ps(m));
+        sumv = _mm256_add_ps(sumv, _mm256_and_ps(c, m));
+        maxv = _mm256_max_ps(maxv, _mm256_blendv_ps(maxv, c, m));
+    }
+
+    float lanes[8], maxLanes[8];
+    _mm256_storeu_ps(lanes, sumv);
+    _mm256_storeu_ps(maxLanes, maxv);
+    for (int k = 0; k < 8; k++)
+    {
+        sum += lanes[k];
+        maxVal = std::max(maxVal, maxLanes[k]);
+    }
+    return j;
+}
+#elif defined(__SSE4_1__)
+static int local_maxima_row_simd(const float* r0, const float* r1, const float* r2, int n,
+                                 int& count, double& sum, float& maxVal)
+{
+    __m128 sumv = _mm_setzero_ps();
+    __m128 maxv = _mm_set1_ps(maxVal);
+    int j = 1;
+    for (; j + 4 <= n; j += 4)
+    {
+        __m128 c = _mm_loadu_ps(r1 + j);
+        __m128 m = _mm_and_ps(
+            _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(c, _mm_loadu_ps(r0 + j - 1)),
+                                  _mm_cmpge_ps(c, _mm_loadu_ps(r0 + j))),
+                       _mm_and_ps(_mm_cmpge_ps(c, _mm_loadu_ps(r0 + j + 1)),
+                                  _mm_cmpge_ps(c, _mm_loadu_ps(r1 + j - 1)))),
+            _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(c, _mm_loadu_ps(r1 + j + 1)),
+                                  _mm_cmpge_ps(c, _mm_loadu_ps(r2 + j - 1))),
+                       _mm_and_ps(_mm_cmpge_ps(c, _mm_loadu_ps(r2 + j)),
+                                  _mm_cmpge_ps(c, _mm_loadu_ps(r2 + j + 1)))));
+
+        count += __builtin_popcount(_mm_movemask_ps(m));
+        sumv = _mm_add_ps(sumv, _mm_and_ps(c, m));
+        maxv = _mm_max_ps(maxv, _mm_blendv_ps(maxv, c, m));
+    }
+
+    float lanes[4], maxLanes[4];
+    _mm_storeu_ps(lanes, sumv);
+    _mm_storeu_ps(maxLanes, maxv);
+    for (int k = 0; k < 4; k++)
+    {
+        sum += lanes[k];
+        maxVal = std::max(maxVal, maxLanes[k]);
+    }
+    return j;
+}
+#else
+static int local_maxima_row_simd(const float*, const float*, const float*, int,
+                                 int&, double&, float&)
+{
+    return 1;
+}
+#endif
+
+/**
+* Gathers the MapStatistics of a single channel float map. Every row is read
+* once for the range and, while it is in cache, as the centre row of the
+* local maxima test (vectorized with AVX2 or SSE4.1 when enabled).
+*
+* @param  I map (CV_32F)
+* @return   statistics of the map
+*/
+static MapStatistics map_statistics(const Mat& I)
+{
+    MapStatistics stats;
+    stats.numLocalMax = 0;
+    stats.sumLocalMax = 0.0;
+    stats.maxLocalMax = -FLT_MAX;
+
+    double minVal, maxVal;
+    minMaxLoc(I.row(0), &minVal, &maxVal, NULL, NULL);
+    stats.minVal = (float) minVal;
+    stats.maxVal = (float) maxVal;
+
+    for (int i = 1; i < I.rows; i++)
+    {
+        const float* r1 = I.ptr<float>(i);
+        for (int j = 0; j < I.cols; j++)
+        {
+            stats.minVal = std::min(stats.minVal, r1[j]);
+            stats.maxVal = std::max(stats.maxVal, r1[j]);
+        }
+        if (i == I.rows - 1)
+        {
+            break;
+        }
+
+        const float* r0 = I.ptr<float>(i-1);
+        const float* r2 = I.ptr<float>(i+1);
+        int j = local_maxima_row_simd(r0, r1, r2, I.cols - 1, stats.numLocalMax,
+                                      stats.sumLocalMax, stats.maxLocalMax);
+        for (; j < I.cols - 1; j++)
+        {
+            float c = r1[j];
+            if (c >= r0[j-1] && c >= r0[j] && c >= r0[j+1] && c >= r1[j-1] && c >= r1[j+1]
+                && c >= r2[j-1] && c >= r2[j] && c >= r2[j+1])
+            {
+                stats.numLocalMax++;
+                stats.sumLocalMax += c;
+                stats.maxLocalMax = std::max(stats.maxLocalMax, c);
+            }
+        }
+    }
+    return stats;
+}
+
 
 /**
 * Normalizes image to [0,1] range then multiplies by standard deviation
@@ -42,14 +196,33 @@ void normalize_by_maxima_diff(Mat input)
 }
 
 /**
-* Wrapper class for noramlizer
+* Wrapper class for noramlizer: scales the map to [0,1] and multiplies it by
+* (global maximum - average local maximum)^2.
 *
-* @param input the input image
+* Local maxima keep their order under the [0,1] scaling, so their statistics
+* are taken on the input in one sweep (map_statistics) and scaled afterwards;
+* the map is then written once with the combined scale and offset.
+*
+* @param input the input image (CV_32F), normalized in place
 */
 void normalize(Mat input)
 {
-    normalize(input, input, 0.0, 1.0, NORM_MINMAX, CV_32F);
-    normalize_by_maxima_diff(input);
+    CV_Assert(input.type() == CV_32F);
+
+    MapStatistics stats = map_statistics(input);
+
+    double range = (double) stats.maxVal - stats.minVal;
+    double scale = (range > DBL_EPSILON) ? 1.0 / range : 0.0;
+
+    double multiplier = 0.0;
+    if (stats.numLocalMax > 0)
+    {
+        double globalMax   = std::max(0.0, (stats.maxLocalMax - stats.minVal) * scale);
+        double localMaxAvg = (stats.sumLocalMax / stats.numLocalMax - stats.minVal) * scale;
+        multiplier = (globalMax - localMaxAvg) * (globalMax - localMaxAvg);
+    }
+
+    input.convertTo(input, CV_32F, scale * multiplier, -stats.minVal * scale * multiplier);
 }
 
 /**
@@ -67,36 +240,27 @@ void normalize_pyramid(Mat* pyramid, int numLayers)
 }
 
 
+/**
+* Average and largest value of the local maxima of a map (pixels not smaller
+* than any of their 8 neighbours, the border excluded). The largest value is
+* at least 0, both are 0 if there is no local maximum.
+*
+* @param  I           map (CV_32F)
+* @param  globalMax   output, largest local maximum
+* @param  localMaxAvg output, average local maximum
+* @return             the average local maximum
+*/
 double get_average_local_maxima(Mat I, float *globalMax, float *localMaxAvg)
 {
-    float globalM = 0.0, sumLocalM = 0.0;
-    int numLocalMax = 0;
-
-    for (int i = 1; i < I.rows-1; i++)
-    {
-        for(int j = 1; j < I.cols-1; j++)
-        {
-            if(I.at<float>(i,j) >= I.at<float>(i-1, j-1) && I.at<float>(i,j) >= I.at<float>(i-1, j+1)
-                && I.at<float>(i,j) >= I.at<float>(i, j-1) && I.at<float>(i,j) >= I.at<float>(i, j+1)
-                && I.at<float>(i,j) >= I.at<float>(i+1, j-1) && I.at<float>(i,j) >= I.at<float>(i+1, j+1)
-                && I.at<float>(i,j) >= I.at<float>(i-1, j) && I.at<float>(i,j) >= I.at<float>(i+1, j))
-            {
-                // cout << sumLocalM << "-" << numLocalMax << " || ";
-                numLocalMax++;
-                sumLocalM += I.at<float>(i,j);
-                if (I.at<float>(i,j) > globalM) {
-                    globalM = I.at<float>(i,j);
-                }
-            }
-        }
-    }
+    MapStatistics stats = map_statistics(I);
 
-    // cout << "Number of local maxima is " << numLocalMax << endl;
-    if (numLocalMax == 0) {
+    // cout << "Number of local maxima is " << stats.numLocalMax << endl;
+    if (stats.numLocalMax == 0) {
         *localMaxAvg = 0.0;
         *globalMax = 0.0;
     } else {
-        *localMaxAvg = sumLocalM / numLocalMax;
-        *globalMax = globalM;
+        *localMaxAvg = (float) (stats.sumLocalMax / stats.numLocalMax);
+        *globalMax = std::max(0.0f, stats.maxLocalMax);
     }
+    return *localMaxAvg;
 }
@@ -5,6 +5,10 @@
 #include <typeinfo>
 #include <iostream>
 #include <cstdio>
+#include <cfloat>
+
+#ifndef NORMALIZE_H
+#define NORMALIZE_H
 
 
 void normalize(cv::Mat);
@@ -13,3 +17,5 @@ void normalize_by_maxima_diff(cv::Mat);
 void normalize_by_stdev(cv::Mat);
 void normalize_pyramid(cv::Mat*, int);
 double get_average_local_maxima(cv::Mat, float*, float*);
+
+#endif
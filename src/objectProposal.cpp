@@ -6,12 +6,59 @@
  */
 
 #include "objectProposal.h"
+#include <algorithm>
+#include <vector>
 
 using namespace std;
 using namespace cv;
 
+// proposals scored per parallel task by topKProposals and firstProposalAbove;
+// fixed, so the split (and the result) does not depend on the thread count
+static const int SCORE_CHUNK = 1024;
+
+// proposals firstProposalAbove scores between two checks for an earlier hit
+static const int CANCEL_CHECK = 256;
+
+// shorter side, in coarse cells, the median proposal keeps in the coarse
+// stage of cascadeTopProposals
+static const int COARSE_CELLS_PER_BOX = 4;
 
 
+/**
+ * The surround of a bounding box: the box enlarged by 21% of its size on
+ * every side, clipped to the map.
+ *
+ * @param  bbox    	bounding box
+ * @param  cols    	width of the map
+ * @param  rows    	height of the map
+ * @param  factor  	output, area of the surround ring over the area of the box
+ * @return         	the surround rectangle (the box included)
+ */
+static Rect surround_box(Rect bbox, int cols, int rows, double& factor)
+{
+	int x1 = bbox.x - (0.21 * bbox.width);
+	int x2 = bbox.x + (1.21 * bbox.width);
+	int y1 = bbox.y - (0.21 * bbox.height);
+	int y2 = bbox.y + (1.21 * bbox.height);
+
+	x1 = x1 < 0 ? 0: x1;
+	x2 = x2 > cols ? cols: x2;
+	y1 = y1 < 0 ? 0: y1;
+	y2 = y2 > rows ? rows: y2;
+
+	factor = ((double)((y2-y1) * (x2-x1)) / (double) (bbox.width * bbox.height)) - 1;
+	return Rect(x1, y1, x2-x1, y2-y1);
+}
+
+/**
+ * Score of a box from the sum of the map inside it and inside its surround
+ * (see calculateSaliencyScore).
+ */
+static inline int box_score(double sumVal, double surrVal, double factor, Rect bbox)
+{
+	return 10000 * ((double) (sumVal - (surrVal/factor)))/((double) bbox.width * bbox.height);
+}
+
 /**
  * Caclulates the saliency confidence score of every bounding box  and returns
  * a sorted list of bounding boxes in terms of saliency score. Score is calculated
@@ -24,32 +71,775 @@ using namespace cv;
  * @return             	int for saliency confidence score in box x 10000.
  */
 int calculateSaliencyScore(Mat& saliencyMap, proposal prop)
+{
+	int score;
+	calculateSaliencyScores(&saliencyMap, 1, prop, &score);
+	return score;
+}
+
+/**
+ * calculateSaliencyScore of one bounding box on several saliency maps of the
+ * same size (e.g. the maps of several objects), sharing the box geometry.
+ *
+ * @param  saliencyMaps	numMaps saliency maps of the scene
+ * @param  numMaps     	number of maps
+ * @param  prop        	the proposal to score
+ * @param  scores      	output, numMaps scores (see calculateSaliencyScore)
+ */
+void calculateSaliencyScores(Mat* saliencyMaps, int numMaps, proposal prop, int* scores)
 {
 	Rect bbox = prop.bbox;
-	
-	// cout << "Rect x " << bbox.x << " , y " << bbox.y << endl;
-	// cout << "Rect w " << bbox.width << " , h " << bbox.height << endl;
+	double factor;
+	Rect surround = surround_box(bbox, saliencyMaps[0].cols, saliencyMaps[0].rows, factor);
 
-	Scalar sumVal = sum(saliencyMap(bbox));
+	for (int k = 0; k < numMaps; k++)
+	{
+		Scalar sumVal = sum(saliencyMaps[k](bbox));
+		Scalar surrVal = sum(saliencyMaps[k](surround)) - sumVal;
 
-	int x1 = bbox.x - (0.21 * bbox.width);
-	int x2 = bbox.x + (1.21 * bbox.width);
-	int y1 = bbox.y - (0.21 * bbox.height);
-	int y2 = bbox.y + (1.21 * bbox.height);
+		// int score = prop.confScore * ((double) (sumVal[0] - (surrVal[0]/factor)))/((double) bbox.width * bbox.height);
+		scores[k] = box_score(sumVal[0], surrVal[0], factor, bbox);
+	}
+}
 
-	x1 = x1 < 0 ? 0: x1;
-	x2 = x2 > saliencyMap.cols ? saliencyMap.cols: x2;
-	y1 = y1 < 0 ? 0: y1;
-	y2 = y2 > saliencyMap.rows ? saliencyMap.rows: y2;
+/**
+ * Summed-area table of a saliency map for integralSaliencyScore, computed
+ * once per map: every box sum is then four lookups, whatever its size.
+ *
+ * @param  saliencyMap 	saliency map of the scene (CV_32F)
+ * @param  integralMap 	output, (rows + 1) x (cols + 1) table (CV_64F)
+ */
+void saliencyIntegral(const Mat& saliencyMap, Mat& integralMap)
+{
+	integral(saliencyMap, integralMap, CV_64F);
+}
 
+/**
+ * Sum of a map over a rectangle, from its summed-area table.
+ */
+static inline double rect_sum(const Mat& integralMap, Rect r)
+{
+	const double* top = integralMap.ptr<double>(r.y);
+	const double* bottom = integralMap.ptr<double>(r.y + r.height);
+	return bottom[r.x + r.width] - bottom[r.x] - top[r.x + r.width] + top[r.x];
+}
 
-	Scalar surrVal = sum(saliencyMap(Rect(x1, y1, x2-x1, y2-y1))) - sumVal;
+/**
+ * calculateSaliencyScore in constant time, from the summed-area table of the
+ * map (see saliencyIntegral) instead of the map. The sums are taken in
+ * double precision, so the scores match calculateSaliencyScore up to the
+ * rounding of the sums. The box must lie inside the map, as for
+ * calculateSaliencyScore.
+ *
+ * @param  integralMap 	summed-area table of the saliency map
+ * @param  prop        	the proposal to score
+ * @return             	int for saliency confidence score in box x 10000.
+ */
+int integralSaliencyScore(const Mat& integralMap, proposal prop)
+{
+	int score;
+	integralSaliencyScores(&integralMap, 1, prop, &score);
+	return score;
+}
+
+/**
+ * integralSaliencyScore of one bounding box on the summed-area tables of
+ * several saliency maps of the same size, sharing the box geometry.
+ *
+ * @param  integralMaps	numMaps summed-area tables (see saliencyIntegral)
+ * @param  numMaps     	number of maps
+ * @param  prop        	the proposal to score
+ * @param  scores      	output, numMaps scores (see calculateSaliencyScore)
+ */
+void integralSaliencyScores(const Mat* integralMaps, int numMaps, proposal prop, int* scores)
+{
+	Rect bbox = prop.bbox;
+	double factor;
+	Rect surround = surround_box(bbox, integralMaps[0].cols - 1, integralMaps[0].rows - 1, factor);
+
+	for (int k = 0; k < numMaps; k++)
+	{
+		double sumVal = rect_sum(integralMaps[k], bbox);
+		double surrVal = rect_sum(integralMaps[k], surround) - sumVal;
+		scores[k] = box_score(sumVal, surrVal, factor, bbox);
+	}
+}
 
-	double factor = ((double)((y2-y1) * (x2-x1)) / (double) (bbox.width * bbox.height)) - 1;
-	// int score = prop.confScore * ((double) (sumVal[0] - (surrVal[0]/factor)))/((double) bbox.width * bbox.height);
-	int score = 10000 * ((double) (sumVal[0] - (surrVal[0]/factor)))/((double) bbox.width * bbox.height);
+/**
+ * Sum of a map over the cells [0, x) x [0, y) for fractional x and y, the map
+ * taken as constant over each cell: the bilinear interpolation of its
+ * summed-area table, which weights the cells cut by the border by the part
+ * of their area inside.
+ *
+ * @param  integralMap 	summed-area table of the map (see saliencyIntegral)
+ * @param  x           	column in map cells, in [0, cols]
+ * @param  y           	row in map cells, in [0, rows]
+ */
+static double table_at(const Mat& integralMap, double x, double y)
+{
+	int i = std::min((int) x, integralMap.cols - 2);
+	int j = std::min((int) y, integralMap.rows - 2);
+	double a = x - i;
+	double b = y - j;
+
+	const double* top = integralMap.ptr<double>(j);
+	const double* bottom = integralMap.ptr<double>(j + 1);
+	return (1 - b) * ((1 - a) * top[i] + a * top[i + 1]) + b * ((1 - a) * bottom[i] + a * bottom[i + 1]);
+}
+
+/**
+ * Sum of a map over an image rectangle scaled into map cells.
+ */
+static double scaled_rect_sum(const Mat& integralMap, Rect r, double sx, double sy)
+{
+	double x1 = r.x * sx, x2 = (r.x + r.width) * sx;
+	double y1 = r.y * sy, y2 = (r.y + r.height) * sy;
+	return table_at(integralMap, x2, y2) - table_at(integralMap, x1, y2)
+	     - table_at(integralMap, x2, y1) + table_at(integralMap, x1, y1);
+}
+
+/**
+ * calculateSaliencyScore of a box given in image pixels, on a saliency map
+ * of any size (e.g. at the scale of the conspicuity maps) without resizing
+ * the map to the image: the box and its surround are mapped into map cells
+ * and the cells they cut are weighted by the part of their area inside.
+ * That is the score on the map upsampled to the image by pixel replication;
+ * the surround is clipped in image coordinates as before. Maps of the size
+ * of the image are scored as in integralSaliencyScore.
+ *
+ * @param  integralMap 	summed-area table of the saliency map (see
+ *                     	saliencyIntegral)
+ * @param  imageSize   	size of the image the boxes are in
+ * @param  prop        	the proposal to score
+ * @return             	int for saliency confidence score in box x 10000.
+ */
+int mapSaliencyScore(const Mat& integralMap, Size imageSize, proposal prop)
+{
+	int score;
+	mapSaliencyScores(&integralMap, 1, imageSize, prop, &score);
 	return score;
+}
+
+/**
+ * mapSaliencyScore of one bounding box on the summed-area tables of several
+ * saliency maps of the same size, sharing the box geometry.
+ *
+ * @param  integralMaps	numMaps summed-area tables (see saliencyIntegral)
+ * @param  numMaps     	number of maps
+ * @param  imageSize   	size of the image the boxes are in
+ * @param  prop        	the proposal to score
+ * @param  scores      	output, numMaps scores (see calculateSaliencyScore)
+ */
+void mapSaliencyScores(const Mat* integralMaps, int numMaps, Size imageSize, proposal prop, int* scores)
+{
+	int mapCols = integralMaps[0].cols - 1;
+	int mapRows = integralMaps[0].rows - 1;
+	if (mapCols == imageSize.width && mapRows == imageSize.height)
+	{
+		integralSaliencyScores(integralMaps, numMaps, prop, scores);
+		return;
+	}
+
+	double sx = (double) mapCols / imageSize.width;
+	double sy = (double) mapRows / imageSize.height;
+
+	Rect bbox = prop.bbox;
+	double factor;
+	Rect surround = surround_box(bbox, imageSize.width, imageSize.height, factor);
+
+	// the sums are in map cells, a cell is 1 / (sx * sy) pixels
+	for (int k = 0; k < numMaps; k++)
+	{
+		double sumVal = scaled_rect_sum(integralMaps[k], bbox, sx, sy) / (sx * sy);
+		double surrVal = scaled_rect_sum(integralMaps[k], surround, sx, sy) / (sx * sy) - sumVal;
+		scores[k] = box_score(sumVal, surrVal, factor, bbox);
+	}
+}
+
+/**
+ * One summed-area table for several maps of the same size, interleaved: the
+ * sums of all maps at a corner are next to each other, so the box sums of
+ * every map (boxMeans) read the same four cache lines.
+ *
+ * @param  maps        	numMaps pointers to CV_32F maps
+ * @param  numMaps     	number of maps
+ * @param  table       	output, (rows + 1) x (cols + 1) table with numMaps
+ *                     	channels (CV_64FC(numMaps))
+ */
+void multiChannelIntegral(const Mat* const* maps, int numMaps, Mat& table)
+{
+	int rows = maps[0]->rows;
+	int cols = maps[0]->cols;
+	table.create(rows + 1, cols + 1, CV_64FC(numMaps));
+	std::fill(table.ptr<double>(0), table.ptr<double>(0) + (cols + 1) * numMaps, 0.0);
+
+	vector<double> rowSums(numMaps);
+	vector<const float*> in(numMaps);
+	for (int y = 0; y < rows; y++)
+	{
+		for (int k = 0; k < numMaps; k++)
+		{
+			in[k] = maps[k]->ptr<float>(y);
+			rowSums[k] = 0;
+		}
+
+		const double* above = table.ptr<double>(y);
+		double* out = table.ptr<double>(y + 1);
+		std::fill(out, out + numMaps, 0.0);
+		for (int x = 0; x < cols; x++)
+		{
+			int at = (x + 1) * numMaps;
+			for (int k = 0; k < numMaps; k++)
+			{
+				rowSums[k] += in[k][x];
+				out[at + k] = above[at + k] + rowSums[k];
+			}
+		}
+	}
+}
+
+/**
+ * Adds weight times the sums of every channel of a multi-channel table over
+ * the cells [0, x) x [0, y) to sums (see table_at).
+ */
+static void add_table_at(const Mat& table, double x, double y, double weight, double* sums)
+{
+	int cn = table.channels();
+	int i = std::min((int) x, table.cols - 2);
+	int j = std::min((int) y, table.rows - 2);
+	double a = x - i;
+	double b = y - j;
+
+	const double* top = table.ptr<double>(j) + i * cn;
+	const double* bottom = table.ptr<double>(j + 1) + i * cn;
+	double w00 = weight * (1 - a) * (1 - b), w01 = weight * a * (1 - b);
+	double w10 = weight * (1 - a) * b, w11 = weight * a * b;
+	for (int k = 0; k < cn; k++)
+	{
+		sums[k] += w00 * top[k] + w01 * top[cn + k] + w10 * bottom[k] + w11 * bottom[cn + k];
+	}
+}
+
+/**
+ * Sums of every channel over an image rectangle scaled into map cells.
+ */
+static void scaled_rect_sums(const Mat& table, Rect r, double sx, double sy, double* sums)
+{
+	double x1 = r.x * sx, x2 = (r.x + r.width) * sx;
+	double y1 = r.y * sy, y2 = (r.y + r.height) * sy;
+
+	std::fill(sums, sums + table.channels(), 0.0);
+	add_table_at(table, x2, y2, 1, sums);
+	add_table_at(table, x1, y2, -1, sums);
+	add_table_at(table, x2, y1, -1, sums);
+	add_table_at(table, x1, y1, 1, sums);
+}
+
+/**
+ * Means of several maps inside a box and in its surround ring (the surround
+ * of calculateSaliencyScore without the box), in constant time per box from
+ * their interleaved summed-area table. Boxes are in image pixels and mapped
+ * onto the maps as in mapSaliencyScore, cells weighted by the part of their
+ * area inside. The ring means are 0 if the ring is empty (the box fills the
+ * image).
+ *
+ * @param  table       	summed-area table of the maps (see multiChannelIntegral)
+ * @param  imageSize   	size of the image the boxes are in
+ * @param  prop        	the proposal
+ * @param  inside      	output, the mean of every map inside the box
+ * @param  ring        	output, the mean of every map in the surround ring
+ */
+void boxMeans(const Mat& table, Size imageSize, proposal prop, double* inside, double* ring)
+{
+	int cn = table.channels();
+	double sx = (double) (table.cols - 1) / imageSize.width;
+	double sy = (double) (table.rows - 1) / imageSize.height;
+
+	Rect bbox = prop.bbox;
+	double factor;
+	Rect surround = surround_box(bbox, imageSize.width, imageSize.height, factor);
+
+	scaled_rect_sums(table, bbox, sx, sy, inside);
+	scaled_rect_sums(table, surround, sx, sy, ring);
+
+	// areas in map cells
+	double boxArea = (double) bbox.width * bbox.height * sx * sy;
+	double ringArea = (double) surround.width * surround.height * sx * sy - boxArea;
+	for (int k = 0; k < cn; k++)
+	{
+		ring[k] = (ringArea > 0) ? (ring[k] - inside[k]) / ringArea : 0;
+		inside[k] /= boxArea;
+	}
+}
 
+/**
+ * Orders (score, index) candidates best first: higher score, then lower
+ * index, so ties keep the proposal order.
+ */
+struct BetterCandidate
+{
+	bool operator()(const pair<int, int>& a, const pair<int, int>& b) const
+	{
+		return a.first > b.first || (a.first == b.first && a.second < b.second);
+	}
+};
+
+/**
+ * Scores one chunk of proposals per task and keeps the k best of each chunk
+ * in a bounded heap (worst candidate on top), for topKProposals.
+ */
+class TopKChunks : public ParallelLoopBody
+{
+public:
+	TopKChunks(const Mat& integralMap, Size imageSize, proposal* objProps, int numProposals, int k,
+	           bool score, vector< vector< pair<int, int> > >& chunkTop)
+		: integralMap(integralMap), imageSize(imageSize), objProps(objProps), numProposals(numProposals),
+		  k(k), score(score), chunkTop(chunkTop)
+	{
+	}
+
+	void operator()(const Range& range) const
+	{
+		BetterCandidate better;
+		for (int c = range.start; c < range.end; c++)
+		{
+			vector< pair<int, int> >& heap = chunkTop[c];
+			heap.clear();
+
+			int end = std::min((c + 1) * SCORE_CHUNK, numProposals);
+			for (int i = c * SCORE_CHUNK; i < end; i++)
+			{
+				if (score)
+				{
+					objProps[i].saliencyScore = mapSaliencyScore(integralMap, imageSize, objProps[i]);
+				}
+				pair<int, int> candidate(objProps[i].saliencyScore, i);
+
+				if ((int) heap.size() < k)
+				{
+					heap.push_back(candidate);
+					push_heap(heap.begin(), heap.end(), better);
+				} else if (better(candidate, heap.front()))
+				{
+					pop_heap(heap.begin(), heap.end(), better);
+					heap.back() = candidate;
+					push_heap(heap.begin(), heap.end(), better);
+				}
+			}
+		}
+	}
+
+private:
+	const Mat& integralMap;
+	Size imageSize;
+	proposal* objProps;
+	int numProposals;
+	int k;
+	bool score;
+	vector< vector< pair<int, int> > >& chunkTop;
+};
+
+/**
+ * Scores all proposals on a saliency map (see mapSaliencyScore) in parallel
+ * chunks and returns the k best. Every chunk keeps its k best in a bounded
+ * heap; the chunk results are merged in chunk order, so the result is the
+ * same for any number of threads.
+ *
+ * @param  integralMap 	summed-area table of the saliency map
+ * @param  imageSize   	size of the image the boxes are in
+ * @param  objProps    	proposals, their saliencyScore is set
+ * @param  numProposals	number of proposals
+ * @param  k           	number of proposals to return
+ * @param  topIndices  	output, min(k, numProposals) proposal indices by
+ *                     	decreasing score (ties keep the proposal order)
+ * @param  score       	false to rank by the saliencyScore the proposals
+ *                     	already have (e.g. after firstProposalAbove found
+ *                     	none), without scoring them again
+ * @return             	number of indices written
+ */
+int topKProposals(const Mat& integralMap, Size imageSize, proposal* objProps, int numProposals, int k,
+                  int* topIndices, bool score)
+{
+	if (k <= 0 || numProposals <= 0)
+	{
+		return 0;
+	}
+
+	int numChunks = (numProposals + SCORE_CHUNK - 1) / SCORE_CHUNK;
+	vector< vector< pair<int, int> > > chunkTop(numChunks);
+	parallel_for_(Range(0, numChunks), TopKChunks(integralMap, imageSize, objProps, numProposals, k, score, chunkTop));
+
+	vector< pair<int, int> > candidates;
+	for (int c = 0; c < numChunks; c++)
+	{
+		candidates.insert(candidates.end(), chunkTop[c].begin(), chunkTop[c].end());
+	}
+
+	int numTop = std::min(k, (int) candidates.size());
+	partial_sort(candidates.begin(), candidates.begin() + numTop, candidates.end(), BetterCandidate());
+	for (int i = 0; i < numTop; i++)
+	{
+		topIndices[i] = candidates[i].second;
+	}
+	return numTop;
+}
+
+/**
+ * Scans one chunk of proposals per task for the first one above a
+ * threshold, for firstProposalAbove. A chunk after one that already has a
+ * hit cannot contain the first hit, so it is skipped, or abandoned when the
+ * hit is found while it is being scanned. firstHitChunk is only accessed
+ * under the mutex, at the start of a chunk and every CANCEL_CHECK proposals.
+ */
+class FirstAboveChunks : public ParallelLoopBody
+{
+public:
+	FirstAboveChunks(const Mat& integralMap, Size imageSize, proposal* objProps, int numProposals, int thresh,
+	                 vector<int>& chunkHit, int& firstHitChunk, Mutex& mutex)
+		: integralMap(integralMap), imageSize(imageSize), objProps(objProps), numProposals(numProposals),
+		  thresh(thresh), chunkHit(chunkHit), firstHitChunk(firstHitChunk), mutex(mutex)
+	{
+	}
+
+	void operator()(const Range& range) const
+	{
+		for (int c = range.start; c < range.end; c++)
+		{
+			int end = std::min((c + 1) * SCORE_CHUNK, numProposals);
+			for (int i = c * SCORE_CHUNK; i < end; i++)
+			{
+				if ((i - c * SCORE_CHUNK) % CANCEL_CHECK == 0 && earlier_hit(c))
+				{
+					break;
+				}
+
+				objProps[i].saliencyScore = mapSaliencyScore(integralMap, imageSize, objProps[i]);
+				if (objProps[i].saliencyScore > thresh)
+				{
+					chunkHit[c] = i;
+					AutoLock lock(mutex);
+					if (c < firstHitChunk)
+					{
+						firstHitChunk = c;
+					}
+					break;
+				}
+			}
+		}
+	}
+
+private:
+	bool earlier_hit(int c) const
+	{
+		AutoLock lock(mutex);
+		return firstHitChunk < c;
+	}
+
+	const Mat& integralMap;
+	Size imageSize;
+	proposal* objProps;
+	int numProposals;
+	int thresh;
+	vector<int>& chunkHit;
+	int& firstHitChunk;
+	Mutex& mutex;
+};
+
+/**
+ * The first proposal, in input order, whose score on a saliency map (see
+ * mapSaliencyScore) is above a threshold. Chunks of proposals are scanned in
+ * parallel and the chunks after the first one with a hit are cancelled;
+ * the answer is always the first hit in input order, whatever the thread
+ * count or scheduling. Only the scanned proposals get their saliencyScore
+ * set: proposals in chunks that were skipped or abandoned keep the
+ * saliencyScore they had before the call, which may be stale. When none is
+ * above thresh, all of them are scored.
+ *
+ * @param  integralMap 	summed-area table of the saliency map
+ * @param  imageSize   	size of the image the boxes are in
+ * @param  objProps    	proposals
+ * @param  numProposals	number of proposals
+ * @param  thresh      	score threshold (see calculateSaliencyScore)
+ * @return             	index of the proposal, -1 if none is above thresh
+ */
+int firstProposalAbove(const Mat& integralMap, Size imageSize, proposal* objProps, int numProposals, int thresh)
+{
+	int numChunks = (numProposals + SCORE_CHUNK - 1) / SCORE_CHUNK;
+	vector<int> chunkHit(numChunks, -1);
+	int firstHitChunk = numChunks;
+	Mutex mutex;
+
+	parallel_for_(Range(0, numChunks), FirstAboveChunks(integralMap, imageSize, objProps, numProposals, thresh,
+	                                                    chunkHit, firstHitChunk, mutex));
+
+	for (int c = 0; c < numChunks; c++)
+	{
+		if (chunkHit[c] >= 0)
+		{
+			return chunkHit[c];
+		}
+	}
+	return -1;
+}
+
+CascadeOptions::CascadeOptions()
+	: coarseLevels(2), rule(CASCADE_TOP_FRACTION), survivalRatio(0.1), boundSigmas(1.0), minSurvivors(10),
+	  compareExhaustive(false)
+{
+}
+
+CascadeStats::CascadeStats()
+	: calls(0), proposals(0), survivors(0), compared(0), winnerChanges(0), scoreLoss(0)
+{
+}
+
+/**
+ * Mean saliency inside each box of one chunk of proposals per task, on the
+ * coarse table of cascadeTopProposals (x 10000, as calculateSaliencyScore).
+ */
+class CoarseScoreChunks : public ParallelLoopBody
+{
+public:
+	CoarseScoreChunks(const Mat& coarseIntegral, double cellArea, Size imageSize, const proposal* objProps,
+	                  int numProposals, int* scores)
+		: coarseIntegral(coarseIntegral), cellArea(cellArea), imageSize(imageSize), objProps(objProps),
+		  numProposals(numProposals), scores(scores)
+	{
+	}
+
+	void operator()(const Range& range) const
+	{
+		double sx = (double) (coarseIntegral.cols - 1) / imageSize.width;
+		double sy = (double) (coarseIntegral.rows - 1) / imageSize.height;
+
+		int end = std::min(range.end * SCORE_CHUNK, numProposals);
+		for (int i = range.start * SCORE_CHUNK; i < end; i++)
+		{
+			Rect bbox = objProps[i].bbox;
+			double area = (double) bbox.width * bbox.height * sx * sy * cellArea;
+			scores[i] = (area > 0) ? cvRound(10000 * scaled_rect_sum(coarseIntegral, bbox, sx, sy) / area) : 0;
+		}
+	}
+
+private:
+	const Mat& coarseIntegral;
+	double cellArea;
+	Size imageSize;
+	const proposal* objProps;
+	int numProposals;
+	int* scores;
+};
+
+/**
+ * Rescores one chunk of (score, index) candidates per task with
+ * mapSaliencyScore, for the fine stage of cascadeTopProposals.
+ */
+class CandidateScoreChunks : public ParallelLoopBody
+{
+public:
+	CandidateScoreChunks(const Mat& integralMap, Size imageSize, proposal* objProps,
+	                     pair<int, int>* candidates, int numCandidates)
+		: integralMap(integralMap), imageSize(imageSize), objProps(objProps), candidates(candidates),
+		  numCandidates(numCandidates)
+	{
+	}
+
+	void operator()(const Range& range) const
+	{
+		int end = std::min(range.end * SCORE_CHUNK, numCandidates);
+		for (int j = range.start * SCORE_CHUNK; j < end; j++)
+		{
+			int i = candidates[j].second;
+			objProps[i].saliencyScore = mapSaliencyScore(integralMap, imageSize, objProps[i]);
+			candidates[j].first = objProps[i].saliencyScore;
+		}
+	}
+
+private:
+	const Mat& integralMap;
+	Size imageSize;
+	proposal* objProps;
+	pair<int, int>* candidates;
+	int numCandidates;
+};
+
+/**
+ * Rescores candidates [begin, end) in parallel chunks (see
+ * CandidateScoreChunks).
+ */
+static void score_candidates(const Mat& integralMap, Size imageSize, proposal* objProps,
+                             vector< pair<int, int> >& candidates, int begin, int end)
+{
+	int numChunks = (end - begin + SCORE_CHUNK - 1) / SCORE_CHUNK;
+	if (numChunks > 0)
+	{
+		parallel_for_(Range(0, numChunks), CandidateScoreChunks(integralMap, imageSize, objProps,
+		                                                        &candidates[begin], end - begin));
+	}
+}
+
+/**
+ * Halvings of the coarse stage: at most maxLevels, fewer when the median
+ * proposal would span less than COARSE_CELLS_PER_BOX coarse cells along its
+ * shorter side (e.g. on a map already at the scale of the conspicuity maps),
+ * where the coarse ranking says little about the fine one.
+ */
+static int coarse_levels(Size mapSize, Size imageSize, const proposal* objProps, int numProposals,
+                         int maxLevels)
+{
+	vector<double> sides(numProposals);
+	double sx = (double) mapSize.width / imageSize.width;
+	double sy = (double) mapSize.height / imageSize.height;
+	for (int i = 0; i < numProposals; i++)
+	{
+		sides[i] = std::min(objProps[i].bbox.width * sx, objProps[i].bbox.height * sy);
+	}
+	nth_element(sides.begin(), sides.begin() + numProposals / 2, sides.end());
+	double median = sides[numProposals / 2];
+
+	int levels = 0;
+	while (levels < maxLevels && median / (2 << levels) >= COARSE_CELLS_PER_BOX
+	       && mapSize.width >> (levels + 1) > 0 && mapSize.height >> (levels + 1) > 0)
+	{
+		levels++;
+	}
+	return levels;
+}
+
+/**
+ * Two stage proposal scoring for many proposals, most of them poor. The
+ * coarse stage scores every proposal by its mean saliency on the map
+ * downsampled coarseLevels times (area averaging), without the surround
+ * term; the survivors (see CascadeRule) are rescored on the map itself with
+ * mapSaliencyScore and the k best returned. The coarse table is sampled
+ * from the caller's summed-area table (every 2^levels-th row and column
+ * of it is the table of the area-averaged map, up to a scale), so only the
+ * survivors pay for the full score. Both stages run in parallel chunks like
+ * topKProposals. coarseLevels is clamped so the median box keeps
+ * COARSE_CELLS_PER_BOX coarse cells (see coarse_levels). Whether the
+ * cascade is faster than topKProposals depends on the survivor fraction;
+ * "benchmark cascade" reports both.
+ *
+ * The winner can differ from the exhaustive one (topKProposals) when the
+ * surround term or the downsampling reorders the boxes enough to drop it;
+ * compareExhaustive measures how often.
+ *
+ * @param  integralMap 	summed-area table of the saliency map (see
+ *                     	saliencyIntegral; any scale, see mapSaliencyScore)
+ * @param  imageSize   	size of the image the boxes are in
+ * @param  objProps    	proposals, the saliencyScore of the survivors is set
+ *                     	(of all of them with compareExhaustive)
+ * @param  numProposals	number of proposals
+ * @param  k           	number of proposals to return
+ * @param  topIndices  	output, min(k, survivors) proposal indices by
+ *                     	decreasing score (ties keep the proposal order)
+ * @param  options     	cascade options
+ * @param  stats       	statistics to accumulate into, or NULL
+ * @return             	number of indices written
+ */
+int cascadeTopProposals(const Mat& integralMap, Size imageSize, proposal* objProps, int numProposals, int k,
+                        int* topIndices, const CascadeOptions& options, CascadeStats* stats)
+{
+	if (k <= 0 || numProposals <= 0)
+	{
+		return 0;
+	}
+
+	// coarse table: the rows and columns of the table on multiples of scale
+	Size mapSize(integralMap.cols - 1, integralMap.rows - 1);
+	int levels = coarse_levels(mapSize, imageSize, objProps, numProposals, options.coarseLevels);
+	int scale = 1 << levels;
+	Mat coarseIntegral = integralMap;
+	if (scale > 1)
+	{
+		coarseIntegral.create(mapSize.height / scale + 1, mapSize.width / scale + 1, CV_64F);
+		for (int y = 0; y < coarseIntegral.rows; y++)
+		{
+			const double* in = integralMap.ptr<double>(y * scale);
+			double* out = coarseIntegral.ptr<double>(y);
+			for (int x = 0; x < coarseIntegral.cols; x++)
+			{
+				out[x] = in[x * scale];
+			}
+		}
+	}
+
+	// coarse stage
+	vector<int> coarseScores(numProposals);
+	int numChunks = (numProposals + SCORE_CHUNK - 1) / SCORE_CHUNK;
+	parallel_for_(Range(0, numChunks), CoarseScoreChunks(coarseIntegral, scale * scale, imageSize, objProps,
+	                                                     numProposals, &coarseScores[0]));
+
+	vector< pair<int, int> > candidates(numProposals);
+	for (int i = 0; i < numProposals; i++)
+	{
+		candidates[i] = make_pair(coarseScores[i], i);
+	}
+
+	int numSurvivors;
+	if (options.rule == CASCADE_ABOVE_BOUND)
+	{
+		double mean = 0, sqMean = 0;
+		for (int i = 0; i < numProposals; i++)
+		{
+			mean += coarseScores[i];
+			sqMean += (double) coarseScores[i] * coarseScores[i];
+		}
+		mean /= numProposals;
+		sqMean /= numProposals;
+		double bound = mean + options.boundSigmas * std::sqrt(std::max(sqMean - mean * mean, 0.0));
+
+		numSurvivors = 0;
+		for (int i = 0; i < numProposals; i++)
+		{
+			numSurvivors += (coarseScores[i] >= bound);
+		}
+	} else
+	{
+		numSurvivors = (int) std::ceil(options.survivalRatio * numProposals);
+	}
+	numSurvivors = std::min(std::max(numSurvivors, std::max(options.minSurvivors, k)), numProposals);
+
+	// the survivors are the numSurvivors best coarse scores (for the bound,
+	// exactly the ones above it unless minSurvivors adds more)
+	nth_element(candidates.begin(), candidates.begin() + numSurvivors - 1, candidates.end(), BetterCandidate());
+
+	// fine stage
+	score_candidates(integralMap, imageSize, objProps, candidates, 0, numSurvivors);
+
+	int numTop = std::min(k, numSurvivors);
+	partial_sort(candidates.begin(), candidates.begin() + numTop, candidates.begin() + numSurvivors,
+	             BetterCandidate());
+	for (int j = 0; j < numTop; j++)
+	{
+		topIndices[j] = candidates[j].second;
+	}
+
+	if (stats)
+	{
+		stats->calls++;
+		stats->proposals += numProposals;
+		stats->survivors += numSurvivors;
+	}
+	if (options.compareExhaustive)
+	{
+		score_candidates(integralMap, imageSize, objProps, candidates, numSurvivors, numProposals);
+		pair<int, int> best = candidates[0];
+		for (int j = numSurvivors; j < numProposals; j++)
+		{
+			if (BetterCandidate()(candidates[j], best))
+			{
+				best = candidates[j];
+			}
+		}
+		if (stats)
+		{
+			stats->compared++;
+			stats->winnerChanges += (best.second != candidates[0].second);
+			stats->scoreLoss += best.first - candidates[0].first;
+		}
+	}
+	return numTop;
 }
 
 /**
@@ -17,6 +17,9 @@
  #include <string>
  #include <cstdio>
 
+#ifndef OBJECT_PROPOSAL_H
+#define OBJECT_PROPOSAL_H
+
 const int NUM_PROPOSALS = 10000;
 /**
  * A structure for object proposals.
@@ -33,8 +36,79 @@ const int NUM_PROPOSALS = 10000;
     int label;
 };
 
+/**
+ * How cascadeTopProposals picks the proposals that survive the coarse stage.
+ * 	CASCADE_TOP_FRACTION  the survivalRatio best coarse scores
+ * 	CASCADE_ABOVE_BOUND   every coarse score of at least mean + boundSigmas
+ * 	                      standard deviations of the coarse scores of the
+ * 	                      image, so fewer survive when a few boxes stand out
+ */
+enum CascadeRule { CASCADE_TOP_FRACTION, CASCADE_ABOVE_BOUND };
+
+/**
+ * Options of cascadeTopProposals.
+ * 	coarseLevels      halvings from the saliency map to the map the coarse
+ * 	                  stage scores on, at most (fewer on small maps, see
+ * 	                  cascadeTopProposals)
+ * 	rule              survivor selection (see CascadeRule)
+ * 	survivalRatio     fraction of the proposals kept by CASCADE_TOP_FRACTION
+ * 	boundSigmas       bound of CASCADE_ABOVE_BOUND, in standard deviations
+ * 	minSurvivors      both rules keep at least this many proposals (the best
+ * 	                  coarse scores)
+ * 	compareExhaustive also score the proposals that did not survive and
+ * 	                  record in CascadeStats whether the winner changed; for
+ * 	                  tuning, it costs the exhaustive scoring
+ */
+struct CascadeOptions
+{
+	int coarseLevels;
+	CascadeRule rule;
+	double survivalRatio;
+	double boundSigmas;
+	int minSurvivors;
+	bool compareExhaustive;
+
+	CascadeOptions();
+};
+
+/**
+ * Counters of cascadeTopProposals, accumulated over the calls given the same
+ * statistics.
+ * 	calls          calls
+ * 	proposals      proposals scored by the coarse stage
+ * 	survivors      proposals rescored by the fine stage
+ * 	compared       calls with compareExhaustive
+ * 	winnerChanges  compared calls whose best proposal differs from the best
+ * 	               of exhaustive scoring
+ * 	scoreLoss      sum over the compared calls of the exhaustive best score
+ * 	               minus the score of the cascade winner
+ */
+struct CascadeStats
+{
+	int calls;
+	long proposals;
+	long survivors;
+	int compared;
+	int winnerChanges;
+	long scoreLoss;
+
+	CascadeStats();
+};
+
 
 int calculateSaliencyScore(cv::Mat&, proposal);
+void calculateSaliencyScores(cv::Mat*, int, proposal, int*);
+void saliencyIntegral(const cv::Mat&, cv::Mat&);
+int integralSaliencyScore(const cv::Mat&, proposal);
+void integralSaliencyScores(const cv::Mat*, int, proposal, int*);
+int mapSaliencyScore(const cv::Mat&, cv::Size, proposal);
+void mapSaliencyScores(const cv::Mat*, int, cv::Size, proposal, int*);
+void multiChannelIntegral(const cv::Mat* const*, int, cv::Mat&);
+void boxMeans(const cv::Mat&, cv::Size, proposal, double*, double*);
+int topKProposals(const cv::Mat&, cv::Size, proposal*, int, int, int*, bool = true);
+int firstProposalAbove(const cv::Mat&, cv::Size, proposal*, int, int);
+int cascadeTopProposals(const cv::Mat&, cv::Size, proposal*, int, int, int*,
+                        const CascadeOptions& = CascadeOptions(), CascadeStats* = NULL);
 int calculateSaliencyScoreProto(cv::Mat&);
 void drawBB(cv::Mat&, proposal, cv::Scalar);
 void drawBB(cv::Mat&, cv::Rect, cv::Scalar);
@@ -42,3 +116,5 @@ void drawBB(cv::Mat&, cv::Rect, cv::Scalar);
 proposal* arrayToProposals(int[][5], int, int);
 double  calculateIOU(cv::Rect, cv::Rect);
 void csvToProposalList(const char*, int[NUM_PROPOSALS][5]);
+
+#endif
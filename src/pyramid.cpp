@@ -0,0 +1,308 @@
+#include "pyramid.h"
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+// every level starts on a multiple of this many elements in the shared buffer
+static const int LEVEL_ALIGN = 64;
+
+/**
+* Halves an image (to the given size, the floor of half the input size) with
+* the decimation of a resampling tier: Gaussian pyrDown, or 2x2 box averaging
+* (area resize) for RESAMPLE_FASTEST.
+*
+* @param src        image
+* @param dst        output image
+* @param size       size of the output
+* @param resampling resampling tier
+*/
+void pyramid_down(const Mat& src, Mat& dst, Size size, Resampling resampling)
+{
+    if (resampling == RESAMPLE_FASTEST)
+    {
+        resize(src, dst, size, 0, 0, INTER_AREA);
+    } else {
+        pyrDown(src, dst, size);
+    }
+}
+
+/**
+* Rows [y0, y1) of pyramid_down(src, dst, dst.size(), resampling), written
+* into dst (allocated by the caller). pyrDown reads input rows 2y-2 .. 2y+2
+* for output row y and extrapolates past the rows it is given, so the band
+* is decimated from its input rows plus two output rows of margin on each
+* side and the margin is dropped: the rows are exactly those of the whole
+* image. Area decimation (RESAMPLE_FASTEST) is only done whole.
+*
+* @param src        image
+* @param dst        output image, of the size pyramid_down gives
+* @param y0         first output row
+* @param y1         one past the last output row
+* @param resampling resampling tier
+* @param scratch    buffer for the decimated band with its margin
+*/
+static void pyramid_down_rows(const Mat& src, Mat& dst, int y0, int y1, Resampling resampling, Mat& scratch)
+{
+    if (y0 == 0 && y1 == dst.rows)
+    {
+        pyramid_down(src, dst, dst.size(), resampling);
+        return;
+    }
+    CV_Assert(resampling != RESAMPLE_FASTEST);
+
+    int s0 = std::max(2*y0 - 4, 0);
+    int s1 = std::min(2*y1 + 4, src.rows);
+    pyrDown(src.rowRange(s0, s1), scratch, Size(dst.cols, (s1 - s0 + 1) / 2));
+
+    Mat band = dst.rowRange(y0, y1);
+    scratch.rowRange(y0 - s0/2, y1 - s0/2).copyTo(band);
+}
+
+Pyramid::Pyramid()
+    : baseLevel(0), type(-1), firstLevel(0), fixedScale(0), inputLevel(0), fixedLevel(0),
+      resampling(RESAMPLE_EXACT)
+{
+}
+
+/**
+* Size of a level: every level halves (rounding down) the previous one, the
+* same sizes construct_pyramid always used. Only defined from the level the
+* pyramid was laid out from (0 unless built from a downsampled image).
+*
+* @param  level pyramid level
+* @return       size of the level
+*/
+Size Pyramid::level_size(int level) const
+{
+    Size size = baseSize;
+    for (int i = baseLevel; i < level; ++i)
+    {
+        size = Size(size.width / 2, size.height / 2);
+    }
+    return size;
+}
+
+/**
+* Lays out levels firstLevel .. numLevels-1 in one buffer. Levels below
+* firstLevel are left for the caller to set (build makes level 0 alias its
+* input). Nothing is allocated if the geometry did not change.
+*
+* @param size       size of level sizeLevel
+* @param numLevels  number of levels
+* @param type       type of every level (e.g. CV_32F)
+* @param firstLevel first level stored in the buffer (>= sizeLevel)
+* @param sizeLevel  level whose size is given
+*/
+void Pyramid::allocate(Size size, int numLevels, int type, int firstLevel, int sizeLevel)
+{
+    if (size == baseSize && sizeLevel == baseLevel && numLevels == levels()
+        && type == this->type && firstLevel == this->firstLevel && !buffer.empty())
+    {
+        return;
+    }
+
+    baseSize = size;
+    baseLevel = sizeLevel;
+    this->type = type;
+    this->firstLevel = firstLevel;
+    levelMats.assign(numLevels, Mat());
+
+    // offset (in elements) of every level, each one starting on a multiple of
+    // LEVEL_ALIGN elements from the start of the buffer
+    vector<int> offsets(numLevels, 0);
+    int total = 0;
+    for (int i = firstLevel; i < numLevels; ++i)
+    {
+        offsets[i] = total;
+        total += (int) alignSize(level_size(i).area(), LEVEL_ALIGN);
+    }
+
+    // levels are reshaped slices of the buffer, so they keep it alive for as
+    // long as any of them is in use
+    buffer.create(1, total, type);
+    for (int i = firstLevel; i < numLevels; ++i)
+    {
+        Size size = level_size(i);
+        levelMats[i] = buffer.colRange(offsets[i], offsets[i] + size.area()).reshape(0, size.height);
+    }
+}
+
+/**
+* Builds a gaussian pyramid with numLevels levels from an input image. The
+* input is used as level inputLevel (0 unless it was already downsampled) and
+* is not copied, so it must stay unchanged for as long as the level is used.
+* Levels below inputLevel are left empty.
+*
+* @param input      image of dimensions larger than 2^(numLevels-inputLevel)
+* @param numLevels  number of levels
+* @param inputLevel level of the input image
+* @param resampling decimation between the levels (see pyramid_down)
+*/
+void Pyramid::build(const Mat& input, int numLevels, int inputLevel, Resampling resampling)
+{
+    begin(input, numLevels, inputLevel, 0, 0, resampling, 1);
+    build_band(0);
+    build_rest();
+}
+
+/**
+* Builds the pyramid of a CV_32F image with the levels from fixedLevel up
+* stored as 16 bit fixed point (CV_16S, value * scale, rounded and
+* saturated): half the memory and memory traffic of those levels. Levels
+* between the input and fixedLevel are computed in float (buffers of the
+* pyramid, reused) and level fixedLevel is their downsampled, converted
+* successor; from there on the decimation works on the fixed point levels.
+*
+* @param input      CV_32F image
+* @param numLevels  number of levels
+* @param inputLevel level of the input image
+* @param fixedLevel first fixed point level (>= inputLevel)
+* @param scale      fixed point scale, see fixed_scale
+* @param resampling decimation between the levels (see pyramid_down)
+*/
+void Pyramid::build_fixed(const Mat& input, int numLevels, int inputLevel, int fixedLevel, double scale,
+                          Resampling resampling)
+{
+    CV_Assert(scale > 0);
+    begin(input, numLevels, inputLevel, fixedLevel, scale, resampling, 1);
+    build_band(0);
+    build_rest();
+}
+
+/**
+* Lays out the pyramid of an input for build_band and build_rest, the first
+* part of build (scale 0) or build_fixed. Fixed point levels at the input
+* level are converted here.
+*
+* @param input      image (CV_32F for fixed point)
+* @param numLevels  number of levels
+* @param inputLevel level of the input image
+* @param fixedLevel first fixed point level (>= inputLevel), unused for float
+* @param scale      fixed point scale, 0 for a float pyramid
+* @param resampling decimation between the levels (see pyramid_down)
+* @param numBands   row bands of the first level above the input (at most
+*                   its rows; 1 for RESAMPLE_FASTEST, see pyramid_down_rows)
+*/
+void Pyramid::begin(const Mat& input, int numLevels, int inputLevel, int fixedLevel, double scale,
+                    Resampling resampling, int numBands)
+{
+    CV_Assert(inputLevel + 1 < numLevels && numBands >= 1);
+
+    this->inputLevel = inputLevel;
+    this->resampling = resampling;
+    fixedScale = scale;
+
+    if (scale > 0)
+    {
+        CV_Assert(input.type() == CV_32F && fixedLevel >= inputLevel);
+        this->fixedLevel = fixedLevel;
+        allocate(input.size(), numLevels, CV_16S, fixedLevel, inputLevel);
+    } else {
+        this->fixedLevel = numLevels;
+        allocate(input.size(), numLevels, input.type(), inputLevel + 1, inputLevel);
+    }
+
+    if (scale > 0 && fixedLevel == inputLevel)
+    {
+        input.convertTo(levelMats[inputLevel], CV_16S, scale);
+    } else {
+        levelMats[inputLevel] = input;
+    }
+
+    // float levels between the input and the first fixed point level, the
+    // last of them is converted as soon as it is computed
+    if (scale > 0)
+    {
+        floatLevels.resize(fixedLevel + 1);
+        for (int i = inputLevel + 1; i <= fixedLevel; ++i)
+        {
+            floatLevels[i].create(level_size(i), CV_32F);
+            if (i < fixedLevel)
+            {
+                levelMats[i] = floatLevels[i];
+            }
+        }
+    }
+
+    if (resampling == RESAMPLE_FASTEST)
+    {
+        numBands = 1;
+    }
+    bandBuffers.resize(std::max(std::min(numBands, level_size(inputLevel + 1).height), 1));
+}
+
+/**
+* Rows [y0, y1) of a level, from the level below (converted to fixed point
+* if it is the first fixed point level).
+*/
+void Pyramid::down_rows(int level, int y0, int y1, Mat& scratch)
+{
+    bool toFixed = fixedScale > 0 && level == fixedLevel;
+    Mat& dst = toFixed ? floatLevels[level] : levelMats[level];
+    pyramid_down_rows(levelMats[level-1], dst, y0, y1, resampling, scratch);
+
+    if (toFixed)
+    {
+        Mat band = levelMats[level].rowRange(y0, y1);
+        floatLevels[level].rowRange(y0, y1).convertTo(band, CV_16S, fixedScale);
+    }
+}
+
+/**
+* Computes one row band of the first level above the input (see begin).
+* Different bands write different rows and buffers, so they can run
+* concurrently.
+*
+* @param band band index, below bands()
+*/
+void Pyramid::build_band(int band)
+{
+    int level = inputLevel + 1;
+    int rows = level_size(level).height;
+    int numBands = bands();
+    down_rows(level, band * rows / numBands, (band + 1) * rows / numBands, bandBuffers[band]);
+}
+
+/**
+* Computes the levels above the first one, once every band of it is built.
+*/
+void Pyramid::build_rest()
+{
+    for (int i = inputLevel + 2; i < levels(); ++i)
+    {
+        down_rows(i, 0, level_size(i).height, bandBuffers[0]);
+    }
+}
+
+/**
+* Number of row bands of the first level above the input (see begin).
+*/
+int Pyramid::bands() const
+{
+    return (int) bandBuffers.size();
+}
+
+/**
+* Scale of the fixed point levels (see build_fixed), 0 if every level holds
+* the values themselves.
+*/
+double Pyramid::fixed_scale() const
+{
+    return fixedScale;
+}
+
+Mat& Pyramid::operator[](int level)
+{
+    return levelMats[level];
+}
+
+const Mat& Pyramid::operator[](int level) const
+{
+    return levelMats[level];
+}
+
+int Pyramid::levels() const
+{
+    return (int) levelMats.size();
+}
@@ -0,0 +1,71 @@
+/**
+* Gaussian pyramid stored in a single allocation.
+*
+* Every level i >= firstLevel is a continuous cv::Mat view into one buffer,
+* starting on an aligned offset, and level 0 aliases the input image instead
+* of copying it. The buffer is kept
+* when the pyramid is rebuilt for an image of the same size and type, so a
+* Pyramid reused across frames allocates only once. build_fixed stores the
+* coarser levels as 16 bit fixed point instead (see fixed_scale).
+*
+* The first decimation (from the input, the largest level by far) can be
+* split into row bands that run on different threads: begin lays out the
+* pyramid, build_band computes one band of the first level above the input
+* and build_rest the coarser levels. The bands give exactly the level
+* build computes.
+*/
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <vector>
+
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+/**
+* Resampling used for the pyramids and the center-surround differences:
+* 	RESAMPLE_EXACT    5x5 Gaussian pyrDown, chains of pyrUp (one per level)
+* 	RESAMPLE_FAST     pyrDown, a single bilinear resize to the target level
+* 	RESAMPLE_FASTEST  2x2 box (area) decimation, a single bilinear resize
+*/
+enum Resampling { RESAMPLE_EXACT, RESAMPLE_FAST, RESAMPLE_FASTEST };
+
+void pyramid_down(const cv::Mat&, cv::Mat&, cv::Size, Resampling);
+
+class Pyramid
+{
+public:
+    Pyramid();
+
+    void allocate(cv::Size, int, int, int = 1, int = 0);
+    void build(const cv::Mat&, int, int = 0, Resampling = RESAMPLE_EXACT);
+    void build_fixed(const cv::Mat&, int, int, int, double, Resampling = RESAMPLE_EXACT);
+    void begin(const cv::Mat&, int, int, int, double, Resampling, int);
+    void build_band(int);
+    void build_rest();
+    int bands() const;
+
+    cv::Mat& operator[](int);
+    const cv::Mat& operator[](int) const;
+    int levels() const;
+    cv::Size level_size(int) const;
+    double fixed_scale() const;
+
+private:
+    void down_rows(int, int, int, cv::Mat&);
+
+    cv::Mat buffer;
+    std::vector<cv::Mat> levelMats;
+    cv::Size baseSize;
+    int baseLevel;
+    int type;
+    int firstLevel;
+    double fixedScale;
+    std::vector<cv::Mat> floatLevels;   // float levels below the fixed point ones
+    int inputLevel;                     // level of the input of the last begin
+    int fixedLevel;                     // first fixed point level
+    Resampling resampling;
+    std::vector<cv::Mat> bandBuffers;   // one per band of build_band
+};
+
+#endif
@@ -1,17 +1,405 @@
 #include "saliency.h"
 #include "normalize.h"
+#include "gabor.h"
+#include "centerSurround.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+// the split_rgbyi kernels are compiled for AVX2 and SSE4.1 whatever the
+// build flags and chosen at run time (see rgbyi_row_simd)
+#define RGBYI_DISPATCH
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 using namespace cv;
 
+// scales of the pipeline (see scales.h)
+static const int numPyrLevels = SaliencyScales::numLevels;
+static const int numCSMaps = SaliencyScales::numMaps;
+static const int cL = SaliencyScales::cL;
+
+// fixed point scales of the channel pyramids (SaliencyOptions::fixedPoint):
+// colors are in [0, 1] and their opponency differences in [-2, 2], intensity
+// is in [0, 255]. The color scale keeps 2 * scale within CV_16S, so the
+// opponency differences never saturate (see CenterSurroundEngine
+// ::opponency_diff).
+static const double COLOR_FIXED_SCALE = (1 << 14) - 1;
+static const double INTENSITY_FIXED_SCALE = 1 << 7;
+
+// row bands every full resolution map of conspicuity_pyramids is split into
+// (see ConspicuityTasks): with 5 channels and 4 orientations 72 tasks for the
+// first stage, enough for 8 and more threads
+static const int ROW_BANDS = 8;
+
+/**
+* Fixed point scale of the pyramid of channel k (red, green, blue, yellow,
+* intensity), 0 if it is stored as float. The intensity pyramid stays float
+* when the orientation filters run on its levels.
+*/
+static double channel_fixed_scale(int k, const SaliencyOptions& options)
+{
+    if (!options.fixedPoint || (k == 4 && options.orientationOnPyramid))
+    {
+        return 0;
+    }
+    return (k == 4) ? INTENSITY_FIXED_SCALE : COLOR_FIXED_SCALE;
+}
+
+/**
+* Whether channel k needs a pyramid: in boxCenterSurround mode only the
+* intensity does, when the orientation filters run on its levels.
+*/
+static bool channel_needs_pyramid(int k, const SaliencyOptions& options)
+{
+    return !options.boxCenterSurround || (k == 4 && options.orientationOnPyramid);
+}
+
+SaliencyWorkspace::SaliencyWorkspace()
+{
+}
+
+/**
+* Workspace with the buffers for frames of a size allocated up front (the
+* remaining ones are sized by the first frame).
+*
+* @param frameSize size of the BGR frames
+* @param options   pipeline options the frames are processed with
+*/
+SaliencyWorkspace::SaliencyWorkspace(Size frameSize, const SaliencyOptions& options)
+{
+    reserve(frameSize, options);
+}
+
+/**
+* Sizes the per-orientation buffers for the options (only when the number of
+* orientations changes).
+*
+* @param options pipeline options
+*/
+void SaliencyWorkspace::fit(const SaliencyOptions& options)
+{
+    size_t numOrient = options.numOrientations;
+    if (orientations.size() != numOrient)
+    {
+        orientations.resize(numOrient);
+        or_cm.resize(numCSMaps * numOrient);
+        orPyr.resize(numOrient);
+        orEngines.resize(numOrient);
+        orBoxEngines.resize(numOrient);
+        orLevelMaps.resize(numOrient);
+    }
+}
+
+/**
+* Allocates the channel, downsampled input and pyramid buffers for frames of
+* a size.
+*
+* @param frameSize size of the BGR frames
+* @param options   pipeline options the frames are processed with
+*/
+void SaliencyWorkspace::reserve(Size frameSize, const SaliencyOptions& options)
+{
+    fit(options);
+
+    Size size = frameSize;
+    for (int level = 0; level < options.startScale; ++level)
+    {
+        size = Size(size.width/2, size.height/2);
+        downsampled[level].create(size, CV_8UC3);
+    }
+
+    for (int k = 0; k < 5; ++k)
+    {
+        channels[k].create(size, CV_32F);
+        if (!channel_needs_pyramid(k, options))
+        {
+            continue;
+        }
+        if (channel_fixed_scale(k, options) > 0)
+        {
+            pyramids[k].allocate(size, numPyrLevels, CV_16S, cL, options.startScale);
+        } else {
+            pyramids[k].allocate(size, numPyrLevels, CV_32F, options.startScale + 1, options.startScale);
+        }
+    }
+
+    for (size_t k = 0; k < orPyr.size(); ++k)
+    {
+        if (options.orientationOnPyramid)
+        {
+            orPyr[k].allocate(pyramids[4].level_size(cL), numPyrLevels, CV_32F, cL, cL);
+        } else if (!options.boxCenterSurround)
+        {
+            orPyr[k].allocate(size, numPyrLevels, CV_32F, options.startScale + 1, options.startScale);
+        }
+    }
+}
+
+SaliencyOptions::SaliencyOptions()
+    : numOrientations(4), steerable(false), steerableBasis(4), orientationOnPyramid(false),
+      startScale(0), numThreads(0), lowMemory(false), fixedPoint(false), resampling(RESAMPLE_EXACT),
+      boxCenterSurround(false), coarseMaps(false),
+      backend(BACKEND_ITTI)
+{
+}
+
+/**
+* Computes the red, green, blue, yellow and intensity values of n consecutive
+* BGR pixels. Scalar version of the vector kernels below, also used for the
+* pixels left over at the end of a row.
+*
+* @param in  pointer to the first BGR pixel
+* @param r_p output row for red (same for g_p, b_p, y_p and i_p)
+* @param n   number of pixels
+*/
+static void rgbyi_row_scalar(const uchar* in, float* r_p, float* g_p, float* b_p,
+                             float* y_p, float* i_p, int n)
+{
+    for (int x = 0; x < n; ++x, in += 3)
+    {
+        float i = (float) (in[0] + in[1] + in[2]);
+        float inv = (i > 0) ? 1.0f / i : 0.0f;
+
+        float b = in[0] * inv;
+        float g = in[1] * inv;
+        float r = in[2] * inv;
+
+        float B = b - (r+g)/2;
+        r_p[x] = std::max(r - (b+g)/2, 0.0f);
+        g_p[x] = std::max(g - (b+r)/2, 0.0f);
+        b_p[x] = std::max(B, 0.0f);
+        y_p[x] = std::max(-B - std::abs(r-g)/2, 0.0f);
+        i_p[x] = i/3;
+    }
+}
+
+#if defined(RGBYI_DISPATCH)
+/**
+* Deinterleaves 8 BGR pixels (24 bytes) into three registers holding the blue,
+* green and red bytes in their low 8 lanes. Only the 24 bytes of the 8 pixels
+* are read, so the last pixels of a row are safe to load.
+*/
+__attribute__((target("sse4.1")))
+static inline void load_bgr8(const uchar* in, __m128i& b, __m128i& g, __m128i& r)
+{
+    const __m128i lo = _mm_loadu_si128((const __m128i*) in);
+    const __m128i hi = _mm_loadl_epi64((const __m128i*) (in + 16));
+
+    b = _mm_or_si128(
+        _mm_shuffle_epi8(lo, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+        _mm_shuffle_epi8(hi, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, -1, -1, -1, -1, -1, -1, -1, -1)));
+    g = _mm_or_si128(
+        _mm_shuffle_epi8(lo, _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+        _mm_shuffle_epi8(hi, _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, -1, -1, -1, -1, -1, -1, -1, -1)));
+    r = _mm_or_si128(
+        _mm_shuffle_epi8(lo, _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+        _mm_shuffle_epi8(hi, _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, -1, -1, -1, -1, -1, -1, -1, -1)));
+}
+
+/**
+* AVX2 kernel: 8 pixels per iteration. The division by intensity is replaced
+* by a reciprocal estimate refined with one Newton-Raphson step, and the
+* thresholding at 0 (as well as the i == 0 case) is done with max/and masks.
+*/
+__attribute__((target("avx2")))
+static int rgbyi_row_avx2(const uchar* in, float* r_p, float* g_p, float* b_p,
+                          float* y_p, float* i_p, int n)
+{
+    const __m256 zero  = _mm256_setzero_ps();
+    const __m256 half  = _mm256_set1_ps(0.5f);
+    const __m256 two   = _mm256_set1_ps(2.0f);
+    const __m256 three = _mm256_set1_ps(3.0f);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+    int x = 0;
+    for (; x + 8 <= n; x += 8)
+    {
+        __m128i b8, g8, r8;
+        load_bgr8(in + 3*x, b8, g8, r8);
+
+        __m256 b = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(b8));
+        __m256 g = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(g8));
+        __m256 r = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(r8));
+
+        __m256 i     = _mm256_add_ps(_mm256_add_ps(b, g), r);
+        __m256 valid = _mm256_cmp_ps(i, zero, _CMP_GT_OQ);
+        __m256 inv   = _mm256_rcp_ps(i);
+        inv = _mm256_mul_ps(inv, _mm256_sub_ps(two, _mm256_mul_ps(i, inv)));
+        inv = _mm256_and_ps(inv, valid);
+
+        b = _mm256_mul_ps(b, inv);
+        g = _mm256_mul_ps(g, inv);
+        r = _mm256_mul_ps(r, inv);
+
+        __m256 R = _mm256_sub_ps(r, _mm256_mul_ps(_mm256_add_ps(b, g), half));
+        __m256 G = _mm256_sub_ps(g, _mm256_mul_ps(_mm256_add_ps(b, r), half));
+        __m256 B = _mm256_sub_ps(b, _mm256_mul_ps(_mm256_add_ps(r, g), half));
+        __m256 Y = _mm256_sub_ps(_mm256_sub_ps(zero, B),
+                                 _mm256_mul_ps(_mm256_and_ps(_mm256_sub_ps(r, g), absMask), half));
+
+        _mm256_storeu_ps(r_p + x, _mm256_max_ps(R, zero));
+        _mm256_storeu_ps(g_p + x, _mm256_max_ps(G, zero));
+        _mm256_storeu_ps(b_p + x, _mm256_max_ps(B, zero));
+        _mm256_storeu_ps(y_p + x, _mm256_max_ps(Y, zero));
+        _mm256_storeu_ps(i_p + x, _mm256_div_ps(i, three));
+    }
+    return x;
+}
+
+/**
+* SSE4.1 kernel: same as the AVX2 kernel, 8 pixels per iteration processed as
+* two groups of 4 lanes.
+*/
+__attribute__((target("sse4.1")))
+static int rgbyi_row_sse41(const uchar* in, float* r_p, float* g_p, float* b_p,
+                           float* y_p, float* i_p, int n)
+{
+    const __m128 zero  = _mm_setzero_ps();
+    const __m128 half  = _mm_set1_ps(0.5f);
+    const __m128 two   = _mm_set1_ps(2.0f);
+    const __m128 three = _mm_set1_ps(3.0f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+    int x = 0;
+    for (; x + 8 <= n; x += 8)
+    {
+        __m128i b8, g8, r8;
+        load_bgr8(in + 3*x, b8, g8, r8);
+
+        for (int k = 0; k < 8; k += 4)
+        {
+            __m128 b = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(b8));
+            __m128 g = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(g8));
+            __m128 r = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(r8));
+            b8 = _mm_srli_si128(b8, 4);
+            g8 = _mm_srli_si128(g8, 4);
+            r8 = _mm_srli_si128(r8, 4);
+
+            __m128 i     = _mm_add_ps(_mm_add_ps(b, g), r);
+            __m128 valid = _mm_cmpgt_ps(i, zero);
+            __m128 inv   = _mm_rcp_ps(i);
+            inv = _mm_mul_ps(inv, _mm_sub_ps(two, _mm_mul_ps(i, inv)));
+            inv = _mm_and_ps(inv, valid);
+
+            b = _mm_mul_ps(b, inv);
+            g = _mm_mul_ps(g, inv);
+            r = _mm_mul_ps(r, inv);
+
+            __m128 R = _mm_sub_ps(r, _mm_mul_ps(_mm_add_ps(b, g), half));
+            __m128 G = _mm_sub_ps(g, _mm_mul_ps(_mm_add_ps(b, r), half));
+            __m128 B = _mm_sub_ps(b, _mm_mul_ps(_mm_add_ps(r, g), half));
+            __m128 Y = _mm_sub_ps(_mm_sub_ps(zero, B),
+                                  _mm_mul_ps(_mm_and_ps(_mm_sub_ps(r, g), absMask), half));
+
+            _mm_storeu_ps(r_p + x + k, _mm_max_ps(R, zero));
+            _mm_storeu_ps(g_p + x + k, _mm_max_ps(G, zero));
+            _mm_storeu_ps(b_p + x + k, _mm_max_ps(B, zero));
+            _mm_storeu_ps(y_p + x + k, _mm_max_ps(Y, zero));
+            _mm_storeu_ps(i_p + x + k, _mm_div_ps(i, three));
+        }
+    }
+    return x;
+}
+#endif
+
+/**
+* Vector kernel for CPUs without AVX2 or SSE4.1: leaves the row to the
+* scalar kernel.
+*/
+static int rgbyi_row_none(const uchar*, float*, float*, float*, float*, float*, int)
+{
+    return 0;
+}
+
+typedef int (*RgbyiRowKernel)(const uchar*, float*, float*, float*, float*, float*, int);
+
+/**
+* The vector kernel of the CPU the program runs on, AVX2 over SSE4.1.
+*/
+static RgbyiRowKernel select_rgbyi_row_kernel()
+{
+#if defined(RGBYI_DISPATCH)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return rgbyi_row_avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1"))
+    {
+        return rgbyi_row_sse41;
+    }
+#endif
+    return rgbyi_row_none;
+}
+
+// vector kernel of split_rgbyi, chosen once at startup
+static const RgbyiRowKernel rgbyi_row_simd = select_rgbyi_row_kernel();
+
 /**
 * Splits an input BGR image into 5 channels: red, green, blue, yellow
 * and intenisty. Calculations were done as described in Itti et al (1998)
 *
+* Pixels are processed 8 at a time with AVX2 or SSE4.1 when the CPU supports
+* them (checked at run time, whatever ATTEND_NATIVE_ARCH), otherwise with the
+* scalar kernel. The vector
+* kernels use a refined reciprocal instead of dividing by the intensity, so
+* red, green, blue and yellow may differ from split_rgbyi_reference by up to
+* 1e-6 (values lie in [0, 1]); intensity is identical.
+*
+* Existing channel Mats of the right size and type are reused.
+*
 * @param input    A BGR image (CV_8U)
-* @param channels An empty array of 3 Mat objects (CV_32F)
+* @param channels An array of 5 Mat objects (CV_32F)
 */
 void split_rgbyi(Mat& input, Mat* channels)
+{
+    CV_Assert(input.type() == CV_8UC3);
+
+    int nRows = input.rows;
+    int nCols = input.cols;
+
+    for (int k = 0; k < 5; ++k)
+    {
+        channels[k].create(nRows, nCols, CV_32F);
+    }
+
+    // treat continuous images as a single long row
+    bool continuous = input.isContinuous();
+    for (int k = 0; k < 5; ++k)
+    {
+        continuous = continuous && channels[k].isContinuous();
+    }
+    if (continuous)
+    {
+        nCols *= nRows;
+        nRows = 1;
+    }
+
+    for (int x = 0; x < nRows; ++x)
+    {
+        const uchar* in_p = input.ptr<uchar>(x);
+        float* r_p = channels[0].ptr<float>(x);
+        float* g_p = channels[1].ptr<float>(x);
+        float* b_p = channels[2].ptr<float>(x);
+        float* y_p = channels[3].ptr<float>(x);
+        float* i_p = channels[4].ptr<float>(x);
+
+        int done = rgbyi_row_simd(in_p, r_p, g_p, b_p, y_p, i_p, nCols);
+        rgbyi_row_scalar(in_p + 3*done, r_p + done, g_p + done, b_p + done,
+                         y_p + done, i_p + done, nCols - done);
+    }
+}
+
+/**
+* Original per-pixel implementation of split_rgbyi. Kept as the reference the
+* vectorized version is validated and benchmarked against.
+*
+* @param input    A BGR image (CV_8U)
+* @param channels An empty array of 5 Mat objects (CV_32F)
+*/
+void split_rgbyi_reference(Mat& input, Mat* channels)
 {
     // Initialize 5 Matrix objects as floats
     int nRows = input.rows;
@@ -68,9 +456,6 @@ void split_rgbyi(Mat& input, Mat* channels)
                 r_p[y] = (R>0) ? R : 0;
                 g_p[y] = (G>0) ? G : 0;
                 y_p[y] = (Y>0) ? Y : 0;
-                // i_p[y] = (b_p[y]+r_p[y]+g_p[y])/3;
-                // i_p[y] = (0.7*b_p[y]+ 0.2*r_p[y]+ 0.8*g_p[y])/3;
-                // i_p[y] = (b_p[y]+r_p[y]+g_p[y] + y_p[y])/4;
                 i_p[y] = i/3;
 
             } else {
@@ -78,6 +463,7 @@ void split_rgbyi(Mat& input, Mat* channels)
                 r_p[y] = 0;
                 g_p[y] = 0;
                 y_p[y] = 0;
+                i_p[y] = 0;
             }
         }
     }
@@ -93,170 +479,1250 @@ void split_rgbyi(Mat& input, Mat* channels)
 
 /**
 * Constructs a gaussing pyramid with numLayers layers from an input image.
+* The input is layer inputLayer itself and the layers above share one buffer,
+* which is reused if the pyramid was already built for an image of the same
+* size.
 *
-* @param input     An Mat of an image of dimensions larger than 2^numlayers
-* @param pyramid   A Mat array (index corresponds to the reduction factor)
-* @param numLayers Number of layers of the pyramid
+* @param input      An Mat of an image of dimensions larger than 2^numlayers
+* @param pyramid    Output pyramid (index corresponds to the reduction factor)
+* @param numLayers  Number of layers of the pyramid
+* @param inputLayer Layer of the input (0 for full resolution)
+* @param fixedScale if not 0, store the layers from the finest center scale up
+*                   as 16 bit fixed point with this scale (Pyramid::build_fixed)
+* @param resampling decimation between the layers (see Resampling)
 */
-void construct_pyramid(Mat& input, Mat* pyramid, int numLayers)
+void construct_pyramid(Mat& input, Pyramid& pyramid, int numLayers, int inputLayer, double fixedScale,
+                       Resampling resampling)
 {
-    //0th layers in the original image
-    pyramid[0] = input.clone();
-    int i;
+    if (fixedScale > 0)
+    {
+        pyramid.build_fixed(input, numLayers, inputLayer, cL, fixedScale, resampling);
+    } else {
+        pyramid.build(input, numLayers, inputLayer, resampling);
+    }
+}
 
-    //Itterate through the pyramid layers with each layer up the pyramid having
-    //half the dimensions
-    for(i = 1; i < numLayers; ++i)
+/**
+* Downsamples the input image to a pyramid level with the same decimation
+* steps (and sizes) construct_pyramid uses, so pyramids built from the result
+* with that input layer line up with full resolution pyramids.
+*
+* @param input      image (any type)
+* @param output     downsampled image, input itself for level 0
+* @param level      pyramid level
+* @param buffers    level buffers to reuse (level of them), NULL to allocate
+* @param resampling decimation (see Resampling)
+*/
+void downsample_input(Mat& input, Mat& output, int level, Mat* buffers, Resampling resampling)
+{
+    output = input;
+    for (int i = 0; i < level; ++i)
     {
-        pyrDown(pyramid[i-1], pyramid[i], Size(pyramid[i-1].cols/2, pyramid[i-1].rows/2));
+        Mat down;
+        Mat& target = buffers ? buffers[i] : down;
+        pyramid_down(output, target, Size(output.cols/2, output.rows/2), resampling);
+        output = target;
     }
 }
 
 /**
 * Calculates the across scale difference between multiple layers of a pyramid
-* and outputs them into the output pyramid
+* and outputs them into the output pyramid. See CenterSurround, which shares
+* the upsampled surround levels between the center-surround pairs.
+*
+* @param inPyr      Input pyramid
+* @param outPyr     Output pyramid
+* @param resampling resampling tier (see Resampling)
+*/
+void across_scale_diff(Pyramid& inPyr, Mat* outPyr, Resampling resampling)
+{
+    CenterSurround engine;
+    engine.diff(inPyr, outPyr, resampling);
+}
+
+/**
+* Calculates the across scale difference between multiple layers of a pyramid
+* for an color opponency featyre and outputs them into the output pyramid
+*
+* @param inPyr1     Input pyramid for first color
+* @param inPyr2     Input pyramid for second color
+* @param outPyr     Output pyramid
+* @param resampling resampling tier (see Resampling)
+*/
+void across_scale_opponency_diff(Pyramid& inPyr1, Pyramid& inPyr2, Mat* outPyr, Resampling resampling)
+{
+    CenterSurround engine;
+    engine.opponency_diff(inPyr1, inPyr2, outPyr, resampling);
+}
+
+/**
+* Calculates the center-surround maps of a channel from box means instead of
+* a pyramid (see BoxCenterSurround); the same maps as across_scale_diff.
+*
+* @param input      channel (CV_32F)
+* @param inputLayer layer of the channel (0 for full resolution)
+* @param outPyr     Output pyramid
+*/
+void box_across_scale_diff(Mat& input, int inputLayer, Mat* outPyr)
+{
+    BoxCenterSurround engine;
+    engine.diff(input, inputLayer, outPyr);
+}
+
+/**
+* Calculates the center-surround maps of a color opponency from box means
+* instead of pyramids; the same maps as across_scale_opponency_diff.
 *
-* @param inPyr  Input pyramid
-* @param outPyr Output pyramid
+* @param input1     first color (CV_32F)
+* @param input2     second color
+* @param inputLayer layer of the channels (0 for full resolution)
+* @param outPyr     Output pyramid
 */
-void across_scale_diff(Mat* inPyr, Mat* outPyr)
+void box_across_scale_opponency_diff(Mat& input1, Mat& input2, int inputLayer, Mat* outPyr)
 {
-    // as defined in itti's paper
-    int cL = 2, cU= 4, sL=3, sU=4;
+    BoxCenterSurround engine;
+    engine.opponency_diff(input1, input2, inputLayer, outPyr);
+}
 
-    //initialize variables
-    int c, s, i = 0;
-    Mat temp;
 
-    for(c = cL; c <= cU; ++c)
+/**
+* Sums numMaps maps of the same size into output in one pass: every output row
+* is written once, adding the maps in order (the same rounding as adding them
+* one after the other). output is (re)allocated only if its size or type does
+* not match, so a caller-owned buffer receives the result.
+*
+* @param maps    array of numMaps pointers to CV_32F maps
+* @param numMaps number of maps (at least 1)
+* @param output  output map (CV_32F)
+*/
+void accumulate_maps(const Mat* const* maps, int numMaps, Mat& output)
+{
+    CV_Assert(numMaps > 0 && maps[0]->type() == CV_32F);
+    for (int k = 1; k < numMaps; ++k)
     {
-        for(s = sL; s <= sU; ++s)
-        {
-            temp = inPyr[c+s].clone();
+        CV_Assert(maps[k]->size() == maps[0]->size() && maps[k]->type() == CV_32F);
+    }
 
-            int j;
-            for(j = s-1 ; j >= 0; --j){
+    output.create(maps[0]->size(), CV_32F);
 
-                pyrUp(temp, temp, Size(inPyr[c+j].cols, inPyr[c+j].rows));
-            }
+    for (int i = 0; i < output.rows; ++i)
+    {
+        float* out = output.ptr<float>(i);
+        const float* in = maps[0]->ptr<float>(i);
+        if (numMaps == 1)
+        {
+            std::copy(in, in + output.cols, out);
+            continue;
+        }
 
-            if (c == cU - 2)
-            {
-                Mat tempX1, tempX2;
-                absdiff(inPyr[c], temp, tempX1);
-                pyrDown(tempX1, tempX2, Size(inPyr[cU-1].cols, inPyr[cU-1].rows));
-                pyrDown(tempX2, outPyr[i], Size(inPyr[cU].cols, inPyr[cU].rows));
-            } else if (c == cU - 1)
+        const float* in1 = maps[1]->ptr<float>(i);
+        for (int j = 0; j < output.cols; ++j)
+        {
+            out[j] = in[j] + in1[j];
+        }
+        for (int k = 2; k < numMaps; ++k)
+        {
+            in = maps[k]->ptr<float>(i);
+            for (int j = 0; j < output.cols; ++j)
             {
-                Mat tempX;
-                absdiff(inPyr[c], temp, tempX);
-                pyrDown(tempX, outPyr[i], Size(inPyr[cU].cols, inPyr[cU].rows));
-            } else {
-                absdiff(inPyr[c], temp, outPyr[i]);
+                out[j] += in[j];
             }
-            ++i;
         }
     }
 }
 
 /**
-* Calculates the across scale difference between multiple layers of a pyramid
-* for an color opponency featyre and outputs them into the output pyramid
-*
-* @param inPyr1 Input pyramid for first color
-* @param inPyr2 Input pyramid for second color
-* @param outPyr Output pyramid
+* Row kernels of weighted_sum_maps, max_weighted_maps and mean_maps: out =
+* w*in, out += w*in, out = max(out, w*in) and the sum of a row. Vectorized
+* with AVX2 or SSE4.1 when the build enables them (see ATTEND_NATIVE_ARCH);
+* the scalar loops handle the rest of the row.
 */
-void across_scale_opponency_diff(Mat* inPyr1, Mat* inPyr2, Mat* outPyr)
+static void scale_row(float* out, const float* in, float w, int n)
 {
-    int cL = 2, cU= 4, sL=3, sU=4;
-    int c, s, i = 0;
-    Mat temp1, temp2, tempC, tempS;
-
-    for(c = cL; c <= cU; ++c)
+    int j = 0;
+#if defined(__AVX2__)
+    const __m256 wv = _mm256_set1_ps(w);
+    for (; j + 8 <= n; j += 8)
     {
-        for(s = sL; s <= sU; ++s)
-        {
-            // scale both to information in first pyramid
-            // while both pyramids should be identical, this is a way to avoid
-            // potential errors and to enforce same dimensions for both
-            temp1 = inPyr1[c+s].clone();
-            temp2 = inPyr2[c+s].clone();
-
-            int j;
-            for(j = s-1 ; j >= 0; --j){
-                Mat tempX1, tempX2;
-                pyrUp(temp1, tempX1, Size(inPyr1[c+j].cols, inPyr1[c+j].rows));
-                pyrUp(temp2, tempX2, Size(inPyr1[c+j].cols, inPyr1[c+j].rows));
-                temp1 = tempX1.clone();
-                temp2 = tempX2.clone();
-            }
-
-            tempC = inPyr1[c] - inPyr2[c];
-            tempS = temp2 - temp1;
-
+        _mm256_storeu_ps(out + j, _mm256_mul_ps(_mm256_loadu_ps(in + j), wv));
+    }
+#elif defined(__SSE4_1__)
+    const __m128 wv = _mm_set1_ps(w);
+    for (; j + 4 <= n; j += 4)
+    {
+        _mm_storeu_ps(out + j, _mm_mul_ps(_mm_loadu_ps(in + j), wv));
+    }
+#endif
+    for (; j < n; ++j)
+    {
+        out[j] = in[j] * w;
+    }
+}
 
-            if (c == cU - 2)
-            {
-                Mat tempX1, tempX2;
-                absdiff(tempC, tempS, tempX1);
-                pyrDown(tempX1, tempX2, Size(inPyr1[cU-1].cols, inPyr1[cU-1].rows));
-                pyrDown(tempX2, outPyr[i], Size(inPyr1[cU].cols, inPyr1[cU].rows));
-            } else if (c == cU - 1)
-            {
-                Mat tempX;
-                absdiff(tempC, tempS, tempX);
-                pyrDown(tempX, outPyr[i], Size(inPyr1[cU].cols, inPyr1[cU].rows));
-            } else {
-                absdiff(tempC, tempS, outPyr[i]);
-            }
-            ++i;
-        }
+static void scale_add_row(float* out, const float* in, float w, int n)
+{
+    int j = 0;
+#if defined(__AVX2__)
+    const __m256 wv = _mm256_set1_ps(w);
+    for (; j + 8 <= n; j += 8)
+    {
+        _mm256_storeu_ps(out + j, _mm256_add_ps(_mm256_loadu_ps(out + j),
+                                                _mm256_mul_ps(_mm256_loadu_ps(in + j), wv)));
+    }
+#elif defined(__SSE4_1__)
+    const __m128 wv = _mm_set1_ps(w);
+    for (; j + 4 <= n; j += 4)
+    {
+        _mm_storeu_ps(out + j, _mm_add_ps(_mm_loadu_ps(out + j),
+                                          _mm_mul_ps(_mm_loadu_ps(in + j), wv)));
+    }
+#endif
+    for (; j < n; ++j)
+    {
+        out[j] += in[j] * w;
     }
 }
 
+static void scale_max_row(float* out, const float* in, float w, int n)
+{
+    int j = 0;
+#if defined(__AVX2__)
+    const __m256 wv = _mm256_set1_ps(w);
+    for (; j + 8 <= n; j += 8)
+    {
+        _mm256_storeu_ps(out + j, _mm256_max_ps(_mm256_loadu_ps(out + j),
+                                                _mm256_mul_ps(_mm256_loadu_ps(in + j), wv)));
+    }
+#elif defined(__SSE4_1__)
+    const __m128 wv = _mm_set1_ps(w);
+    for (; j + 4 <= n; j += 4)
+    {
+        _mm_storeu_ps(out + j, _mm_max_ps(_mm_loadu_ps(out + j),
+                                          _mm_mul_ps(_mm_loadu_ps(in + j), wv)));
+    }
+#endif
+    for (; j < n; ++j)
+    {
+        out[j] = std::max(out[j], in[j] * w);
+    }
+}
 
-void integrate_single_pyramid(Mat* pyramid, Mat f_map, int numLayers)
+static double sum_row(const float* in, int n)
 {
-    int i;
-    add(pyramid[0], pyramid[1], f_map);
-    for (i = 2; i < numLayers; ++i)
+    double sum = 0.0;
+    int j = 0;
+#if defined(__AVX2__)
+    __m256 sumv = _mm256_setzero_ps();
+    for (; j + 8 <= n; j += 8)
+    {
+        sumv = _mm256_add_ps(sumv, _mm256_loadu_ps(in + j));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, sumv);
+    for (int k = 0; k < 8; ++k)
+    {
+        sum += lanes[k];
+    }
+#elif defined(__SSE4_1__)
+    __m128 sumv = _mm_setzero_ps();
+    for (; j + 4 <= n; j += 4)
+    {
+        sumv = _mm_add_ps(sumv, _mm_loadu_ps(in + j));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, sumv);
+    for (int k = 0; k < 4; ++k)
+    {
+        sum += lanes[k];
+    }
+#endif
+    for (; j < n; ++j)
     {
-        f_map = f_map + pyramid[i];
+        sum += in[j];
     }
+    return sum;
 }
 
-void integrate_color_pyamids(Mat* pyramid1, Mat* pyramid2, Mat f_map, int numLayers)
+/**
+* Weighted sum of numMaps maps of the same size, output = sum_k weights[k] *
+* maps[k], in one pass: every output row is written once while the rows of
+* all maps are streamed through it, so no scaled copies of the maps are made.
+* output is (re)allocated only if its size or type does not match.
+*
+* @param maps    array of numMaps pointers to CV_32F maps
+* @param weights numMaps weights
+* @param numMaps number of maps (at least 1)
+* @param output  output map (CV_32F)
+*/
+void weighted_sum_maps(const Mat* const* maps, const float* weights, int numMaps, Mat& output)
 {
-    int i;
-    add(pyramid1[0], pyramid2[0], f_map);
-    for (i = 1; i < numLayers; ++i)
+    CV_Assert(numMaps > 0 && maps[0]->type() == CV_32F);
+    for (int k = 1; k < numMaps; ++k)
     {
-        f_map = f_map + pyramid1[i] + pyramid2[i];
+        CV_Assert(maps[k]->size() == maps[0]->size() && maps[k]->type() == CV_32F);
     }
 
+    output.create(maps[0]->size(), CV_32F);
+
+    for (int i = 0; i < output.rows; ++i)
+    {
+        float* out = output.ptr<float>(i);
+        scale_row(out, maps[0]->ptr<float>(i), weights[0], output.cols);
+        for (int k = 1; k < numMaps; ++k)
+        {
+            scale_add_row(out, maps[k]->ptr<float>(i), weights[k], output.cols);
+        }
+    }
 }
 
-void integrate_orient_pyamids(Mat* pyr1, Mat* pyr2, Mat* pyr3, Mat* pyr4, Mat f_map, int numLayers)
+/**
+* Winner-take-all counterpart of weighted_sum_maps, output = max_k weights[k] *
+* maps[k], in the same single pass.
+*
+* @param maps    array of numMaps pointers to CV_32F maps
+* @param weights numMaps weights
+* @param numMaps number of maps (at least 1)
+* @param output  output map (CV_32F)
+*/
+void max_weighted_maps(const Mat* const* maps, const float* weights, int numMaps, Mat& output)
 {
+    CV_Assert(numMaps > 0 && maps[0]->type() == CV_32F);
+    for (int k = 1; k < numMaps; ++k)
+    {
+        CV_Assert(maps[k]->size() == maps[0]->size() && maps[k]->type() == CV_32F);
+    }
 
-    Mat fmap1(pyr1[0].rows, pyr1[0].cols, CV_32F, Scalar(0.0));
-    Mat fmap2(pyr1[0].rows, pyr1[0].cols, CV_32F, Scalar(0.0));
-    Mat fmap3(pyr1[0].rows, pyr1[0].cols, CV_32F, Scalar(0.0));
-    Mat fmap4(pyr1[0].rows, pyr1[0].cols, CV_32F, Scalar(0.0));
+    output.create(maps[0]->size(), CV_32F);
 
-    integrate_single_pyramid(pyr1, fmap1, 6);
-    integrate_single_pyramid(pyr2, fmap2, 6);
-    integrate_single_pyramid(pyr3, fmap3, 6);
-    integrate_single_pyramid(pyr4, fmap4, 6);
+    for (int i = 0; i < output.rows; ++i)
+    {
+        float* out = output.ptr<float>(i);
+        scale_row(out, maps[0]->ptr<float>(i), weights[0], output.cols);
+        for (int k = 1; k < numMaps; ++k)
+        {
+            scale_max_row(out, maps[k]->ptr<float>(i), weights[k], output.cols);
+        }
+    }
+}
 
-    normalize(fmap1);
-    normalize(fmap2);
-    normalize(fmap3);
-    normalize(fmap4);
+/**
+* Rows of weighted_sum_maps_batch. Each row of the maps is read once and used
+* for every output while it is in cache, so the cost of K outputs is K row
+* products on cached data plus a single pass over the maps (a matrix product
+* of the K x numMaps weights with the numMaps x pixels maps). Bands of rows
+* are independent and run on the OpenCV thread pool.
+*/
+class BatchedWeightedSum : public ParallelLoopBody
+{
+public:
+    BatchedWeightedSum(const Mat* const* maps, const float* weights, int numMaps, int numOutputs,
+                       Mat* outputs)
+        : maps(maps), weights(weights), numMaps(numMaps), numOutputs(numOutputs), outputs(outputs)
+    {
+    }
 
-    f_map = fmap1 + fmap2;
-    f_map = f_map + fmap3;
-    f_map = f_map + fmap4;
+    void operator()(const Range& range) const
+    {
+        int cols = outputs[0].cols;
+        for (int i = range.start; i < range.end; ++i)
+        {
+            for (int o = 0; o < numOutputs; ++o)
+            {
+                const float* w = weights + o * numMaps;
+                float* out = outputs[o].ptr<float>(i);
+                scale_row(out, maps[0]->ptr<float>(i), w[0], cols);
+                for (int k = 1; k < numMaps; ++k)
+                {
+                    scale_add_row(out, maps[k]->ptr<float>(i), w[k], cols);
+                }
+            }
+        }
+    }
 
+private:
+    const Mat* const* maps;
+    const float* weights;
+    int numMaps;
+    int numOutputs;
+    Mat* outputs;
+};
+
+/**
+* numOutputs weighted sums of the same maps at once, outputs[o] = sum_k
+* weights[o*numMaps + k] * maps[k]; every output equals weighted_sum_maps with
+* its row of weights, but the maps are streamed from memory only once.
+* Outputs are (re)allocated only if their size or type does not match.
+*
+* @param maps       array of numMaps pointers to CV_32F maps of the same size
+* @param weights    numOutputs x numMaps weights, row-major
+* @param numMaps    number of maps (at least 1)
+* @param numOutputs number of weighted sums
+* @param outputs    output maps (CV_32F)
+*/
+void weighted_sum_maps_batch(const Mat* const* maps, const float* weights, int numMaps, int numOutputs,
+                             Mat* outputs)
+{
+    CV_Assert(numMaps > 0 && maps[0]->type() == CV_32F);
+    for (int k = 1; k < numMaps; ++k)
+    {
+        CV_Assert(maps[k]->size() == maps[0]->size() && maps[k]->type() == CV_32F);
+    }
+    if (numOutputs <= 0)
+    {
+        return;
+    }
+
+    for (int o = 0; o < numOutputs; ++o)
+    {
+        outputs[o].create(maps[0]->size(), CV_32F);
+    }
+
+    BatchedWeightedSum rows(maps, weights, numMaps, numOutputs, outputs);
+    parallel_for_(Range(0, outputs[0].rows), rows);
+}
+
+/**
+* Means of numMaps single channel float maps (the maps may differ in size),
+* each computed in one pass over its rows.
+*
+* @param maps    array of numMaps pointers to CV_32F maps
+* @param numMaps number of maps
+* @param means   output, numMaps means
+*/
+void mean_maps(const Mat* const* maps, int numMaps, double* means)
+{
+    for (int k = 0; k < numMaps; ++k)
+    {
+        const Mat& map = *maps[k];
+        CV_Assert(map.type() == CV_32F);
+
+        double sum = 0.0;
+        for (int i = 0; i < map.rows; ++i)
+        {
+            sum += sum_row(map.ptr<float>(i), map.cols);
+        }
+        means[k] = (map.rows * map.cols > 0) ? sum / (map.rows * map.cols) : 0.0;
+    }
+}
+
+/**
+* Sums the maps of a conspicuity pyramid into f_map.
+*
+* @param pyramid   conspicuity pyramid
+* @param f_map     output map
+* @param numLayers number of maps in the pyramid (at most numMaps of
+*                  SaliencyScales)
+*/
+void integrate_single_pyramid(Mat* pyramid, Mat& f_map, int numLayers)
+{
+    CV_Assert(numLayers <= numCSMaps);
+    const Mat* maps[numCSMaps];
+    for (int i = 0; i < numLayers; ++i)
+    {
+        maps[i] = &pyramid[i];
+    }
+    accumulate_maps(maps, numLayers, f_map);
+}
+
+/**
+* Sums the maps of two conspicuity pyramids into f_map.
+*
+* @param pyramid1  first conspicuity pyramid
+* @param pyramid2  second conspicuity pyramid
+* @param f_map     output map
+* @param numLayers number of maps in each pyramid (at most numMaps of
+*                  SaliencyScales)
+*/
+void integrate_color_pyamids(Mat* pyramid1, Mat* pyramid2, Mat& f_map, int numLayers)
+{
+    CV_Assert(numLayers <= numCSMaps);
+    const Mat* maps[2*numCSMaps];
+    for (int i = 0; i < numLayers; ++i)
+    {
+        maps[2*i]   = &pyramid1[i];
+        maps[2*i+1] = &pyramid2[i];
+    }
+    accumulate_maps(maps, 2*numLayers, f_map);
+}
+
+/**
+* Integrates the conspicuity pyramids of all orientations into a single
+* orientation map, normalizing each orientation first.
+*
+* @param pyramids        numOrientations pyramids of numLayers maps, stored
+*                        one after the other
+* @param numOrientations number of orientations
+* @param f_map           output map
+* @param numLayers       number of maps in each pyramid
+* @param scratch         map to reuse for one orientation, NULL to allocate
+*/
+void integrate_orient_pyamids(Mat* pyramids, int numOrientations, Mat& f_map, int numLayers,
+                              Mat* scratch)
+{
+    integrate_single_pyramid(pyramids, f_map, numLayers);
+    normalize(f_map);
+
+    Mat local;
+    Mat& fmap = scratch ? *scratch : local;
+    for (int k = 1; k < numOrientations; ++k)
+    {
+        integrate_single_pyramid(pyramids + k*numLayers, fmap, numLayers);
+        normalize(fmap);
+        add(f_map, fmap, f_map);
+    }
+}
+
+/**
+* Calculates the orientation feature maps of the intensity channel. Map k has
+* orientation k*180/numOrientations degrees, so 0, 45, 90 and 135 degrees are
+* maps 0, n/4, n/2 and 3n/4.
+*
+* @param intensity    intensity channel (CV_32F)
+* @param orientations array of options.numOrientations output maps
+* @param options      pipeline options (orientation count and steerable mode)
+*/
+void compute_orientations(Mat& intensity, Mat* orientations, const SaliencyOptions& options)
+{
+    CV_Assert(options.numOrientations > 0 && options.numOrientations % 4 == 0);
+
+    GaborParams params = itti_gabor_params(options.numOrientations);
+    if (options.steerable)
+    {
+        cached_steerable_gabor(options.steerableBasis).apply(intensity, params.thetas, orientations);
+    } else {
+        cached_gabor_bank(params).apply(intensity, orientations);
+    }
+}
+
+/**
+* Calculates orientation map k of compute_orientations on its own, for callers
+* that hold one orientation map at a time: with a bank of that orientation's
+* kernel only or, in steerable mode, with the steered kernel (the same map up
+* to float round-off).
+*
+* @param intensity   intensity channel (CV_32F)
+* @param k           orientation index, angle k*180/numOrientations degrees
+* @param orientation output map (CV_32F)
+* @param options     pipeline options (orientation count and steerable mode)
+*/
+void compute_orientation(Mat& intensity, int k, Mat& orientation, const SaliencyOptions& options)
+{
+    GaborParams params = itti_gabor_params(options.numOrientations);
+    double theta = params.thetas[k];
+
+    if (options.steerable)
+    {
+        Mat kernel = cached_steerable_gabor(options.steerableBasis).steered_kernel(theta);
+        filter2D(intensity, orientation, CV_32F, kernel);
+        return;
+    }
+
+    params.thetas.assign(1, theta);
+    cached_gabor_bank(params).apply(intensity, &orientation);
+}
+
+/**
+* Builds the normalized conspicuity pyramids of the orientation maps.
+*
+* @param orientations    orientation feature maps
+* @param or_cm           output, numMaps conspicuity maps per orientation
+* @param numOrientations number of orientation maps
+* @param inputLayer      pyramid layer of the orientation maps
+* @param orPyr           pyramids to reuse (one per orientation), NULL to
+*                        allocate
+* @param engines         center-surround engines to reuse (one per
+*                        orientation), NULL to allocate
+* @param resampling      resampling tier (see Resampling)
+*/
+void orientation_conspicuity(Mat* orientations, Mat* or_cm, int numOrientations, int inputLayer,
+                             Pyramid* orPyr, CenterSurround* engines, Resampling resampling)
+{
+    for (int k = 0; k < numOrientations; ++k)
+    {
+        Pyramid localPyr;
+        CenterSurround localEngine;
+        Pyramid& pyramid = orPyr ? orPyr[k] : localPyr;
+        CenterSurround& engine = engines ? engines[k] : localEngine;
+
+        construct_pyramid(orientations[k], pyramid, numPyrLevels, inputLayer, 0, resampling);
+        engine.diff(pyramid, or_cm + numCSMaps*k, resampling);
+        normalize_pyramid(or_cm + numCSMaps*k, numCSMaps);
+    }
+}
+
+/**
+* Calculates the orientation feature maps and their normalized conspicuity
+* pyramids.
+*
+* By default the orientation maps are computed on the full resolution
+* intensity channel and a pyramid is built from each. With
+* options.orientationOnPyramid the filters are applied to the levels of the
+* intensity pyramid instead (as in Itti et al), only for levels cL and up since
+* across_scale_diff never reads the finer ones. The orientation feature maps
+* returned are then the level cL responses.
+*
+* Reads the intensity channel and its pyramid (built at level
+* options.startScale) from the workspace and writes workspace.orientations
+* and workspace.or_cm.
+*
+* @param workspace pipeline buffers (see SaliencyWorkspace::fit)
+* @param options   pipeline options
+*/
+void orientation_features(SaliencyWorkspace& workspace, const SaliencyOptions& options)
+{
+    int numOrient = options.numOrientations;
+    Mat* orientations = &workspace.orientations[0];
+    Mat* or_cm = &workspace.or_cm[0];
+    Pyramid* orPyr = &workspace.orPyr[0];
+    Pyramid& intensPyr = workspace.pyramids[4];
+
+    // the across scale differences start at center level cL
+    CV_Assert(options.startScale >= 0 && options.startScale <= cL);
+
+    if (!options.orientationOnPyramid)
+    {
+        compute_orientations(workspace.channels[4], orientations, options);
+        if (options.boxCenterSurround)
+        {
+            for (int k = 0; k < numOrient; ++k)
+            {
+                workspace.orBoxEngines[k].diff(orientations[k], options.startScale, or_cm + numCSMaps*k);
+                normalize_pyramid(or_cm + numCSMaps*k, numCSMaps);
+            }
+        } else {
+            orientation_conspicuity(orientations, or_cm, numOrient, options.startScale,
+                                    orPyr, &workspace.orEngines[0], options.resampling);
+        }
+        return;
+    }
+
+    // orientation pyramids with levels cL and up only, the filters write
+    // straight into the pyramid levels
+    for (int k = 0; k < numOrient; ++k)
+    {
+        orPyr[k].allocate(intensPyr.level_size(cL), numPyrLevels, CV_32F, cL, cL);
+    }
+
+    for (int level = cL; level < numPyrLevels; ++level)
+    {
+        for (int k = 0; k < numOrient; ++k)
+        {
+            workspace.orLevelMaps[k] = orPyr[k][level];
+        }
+        compute_orientations(intensPyr[level], &workspace.orLevelMaps[0], options);
+    }
+
+    for (int k = 0; k < numOrient; ++k)
+    {
+        workspace.orEngines[k].diff(orPyr[k], or_cm + numCSMaps*k, options.resampling);
+        normalize_pyramid(or_cm + numCSMaps*k, numCSMaps);
+        orientations[k] = orPyr[k][cL];
+    }
+}
+
+/**
+* Tasks of conspicuity_pyramids, in three stages joined by parallel_for_:
+* 	DECIMATE     row bands of the first decimation of the five channel
+* 	             pyramids and, unless they are computed on the pyramid, row
+* 	             bands of the orientation maps (one task per orientation and
+* 	             band, or per band for the steerable basis)
+* 	PYRAMIDS     the coarser levels of the channel pyramids, and row bands of
+* 	             the first decimation of the orientation pyramids
+* 	CONSPICUITY  the normalized conspicuity pyramids of intensity, both
+* 	             opponencies and every orientation, one task each (on levels
+* 	             cL and up, or on the orientation maps for box engines)
+* The full resolution work, which dominates, is split into ROW_BANDS bands per
+* map; a band gives exactly the rows of the whole map (see
+* Pyramid::build_band and GaborBank::apply_rows), so the split does not
+* change the result. Each task writes only its own rows and buffers of the
+* workspace, so the tasks of a stage can run in any order and on any thread.
+*/
+class ConspicuityTasks : public ParallelLoopBody
+{
+public:
+    enum Stage { DECIMATE, PYRAMIDS, CONSPICUITY };
+
+    ConspicuityTasks(Stage stage, SaliencyWorkspace& workspace, const SaliencyOptions& options)
+        : stage(stage), ws(workspace), options(options), bank(NULL), steerable(NULL),
+          params(itti_gabor_params(options.numOrientations))
+    {
+        // the banks are looked up here, the tasks only read them
+        if (stage == DECIMATE && !options.orientationOnPyramid)
+        {
+            if (options.steerable)
+            {
+                steerable = &cached_steerable_gabor(options.steerableBasis);
+            } else {
+                bank = &cached_gabor_bank(params);
+            }
+        }
+    }
+
+    int num_tasks() const
+    {
+        switch (stage)
+        {
+        case DECIMATE:
+            return 5*ROW_BANDS + num_gabor_tasks();
+        case PYRAMIDS:
+            return 5 + (orientation_pyramids() ? options.numOrientations*ROW_BANDS : 0);
+        default:
+            return 3 + options.numOrientations;
+        }
+    }
+
+    // tasks filtering the full resolution orientation maps
+    int num_gabor_tasks() const
+    {
+        if (options.orientationOnPyramid)
+        {
+            return 0;
+        }
+        return options.steerable ? ROW_BANDS : options.numOrientations*ROW_BANDS;
+    }
+
+    // whether the orientation maps get pyramids of their own
+    bool orientation_pyramids() const
+    {
+        return !options.orientationOnPyramid && !options.boxCenterSurround;
+    }
+
+    void operator()(const Range& range) const
+    {
+        for (int task = range.start; task < range.end; ++task)
+        {
+            switch (stage)
+            {
+            case DECIMATE:    decimate(task);    break;
+            case PYRAMIDS:    pyramids(task);    break;
+            default:          conspicuity(task); break;
+            }
+        }
+    }
+
+private:
+    void decimate(int task) const
+    {
+        if (task < 5*ROW_BANDS)
+        {
+            int k = task / ROW_BANDS, band = task % ROW_BANDS;
+            if (channel_needs_pyramid(k, options) && band < ws.pyramids[k].bands())
+            {
+                ws.pyramids[k].build_band(band);
+            }
+            return;
+        }
+
+        task -= 5*ROW_BANDS;
+        Mat& intensity = ws.channels[4];
+        int band = task % ROW_BANDS;
+        int y0 = band * intensity.rows / ROW_BANDS;
+        int y1 = (band + 1) * intensity.rows / ROW_BANDS;
+        Mat& scratch = ws.bandScratch[task];
+
+        if (steerable)
+        {
+            const GaborBank& basis = steerable->basis_bank();
+            for (int j = 0; j < basis.size(); ++j)
+            {
+                basis.apply_rows(intensity, j, ws.orBasis[j], y0, y1, scratch);
+            }
+            for (int k = 0; k < options.numOrientations; ++k)
+            {
+                steerable->steer_rows(&ws.orBasis[0], params.thetas[k], ws.orientations[k], y0, y1);
+            }
+        } else {
+            int k = task / ROW_BANDS;
+            bank->apply_rows(intensity, k, ws.orientations[k], y0, y1, scratch);
+        }
+    }
+
+    void pyramids(int task) const
+    {
+        if (task < 5)
+        {
+            if (channel_needs_pyramid(task, options))
+            {
+                ws.pyramids[task].build_rest();
+            }
+            return;
+        }
+
+        task -= 5;
+        Pyramid& orPyr = ws.orPyr[task / ROW_BANDS];
+        if (task % ROW_BANDS < orPyr.bands())
+        {
+            orPyr.build_band(task % ROW_BANDS);
+        }
+    }
+
+    void conspicuity(int task) const
+    {
+        if (options.boxCenterSurround && box_conspicuity(task))
+        {
+            return;
+        }
+
+        switch (task)
+        {
+        case 0:
+            ws.engines[0].diff(ws.pyramids[4], ws.intens_cm, options.resampling);
+            normalize_pyramid(ws.intens_cm, numCSMaps);
+            break;
+        case 1:
+            ws.engines[1].opponency_diff(ws.pyramids[0], ws.pyramids[1], ws.oppRG_cm, options.resampling);
+            normalize_pyramid(ws.oppRG_cm, numCSMaps);
+            break;
+        case 2:
+            ws.engines[2].opponency_diff(ws.pyramids[2], ws.pyramids[3], ws.oppBY_cm, options.resampling);
+            normalize_pyramid(ws.oppBY_cm, numCSMaps);
+            break;
+        default:
+            int k = task - 3;
+            if (options.orientationOnPyramid)
+            {
+                // levels cL and up of the intensity pyramid, filtered with the
+                // bank of this orientation only
+                Pyramid& intensPyr = ws.pyramids[4];
+                for (int level = cL; level < numPyrLevels; ++level)
+                {
+                    compute_orientation(intensPyr[level], k, ws.orPyr[k][level], options);
+                }
+                ws.orientations[k] = ws.orPyr[k][cL];
+            } else {
+                ws.orPyr[k].build_rest();
+            }
+            ws.orEngines[k].diff(ws.orPyr[k], &ws.or_cm[numCSMaps*k], options.resampling);
+            normalize_pyramid(&ws.or_cm[numCSMaps*k], numCSMaps);
+        }
+    }
+
+    // the box engine form of conspicuity, false for the tasks it leaves to
+    // the pyramid engines (orientations filtered on the pyramid)
+    bool box_conspicuity(int task) const
+    {
+        int scale = options.startScale;
+        switch (task)
+        {
+        case 0:
+            ws.boxEngines[0].diff(ws.channels[4], scale, ws.intens_cm);
+            normalize_pyramid(ws.intens_cm, numCSMaps);
+            return true;
+        case 1:
+            ws.boxEngines[1].opponency_diff(ws.channels[0], ws.channels[1], scale, ws.oppRG_cm);
+            normalize_pyramid(ws.oppRG_cm, numCSMaps);
+            return true;
+        case 2:
+            ws.boxEngines[2].opponency_diff(ws.channels[2], ws.channels[3], scale, ws.oppBY_cm);
+            normalize_pyramid(ws.oppBY_cm, numCSMaps);
+            return true;
+        default:
+            if (options.orientationOnPyramid)
+            {
+                return false;
+            }
+            int k = task - 3;
+            ws.orBoxEngines[k].diff(ws.orientations[k], scale, &ws.or_cm[numCSMaps*k]);
+            normalize_pyramid(&ws.or_cm[numCSMaps*k], numCSMaps);
+            return true;
+        }
+    }
+
+    Stage stage;
+    SaliencyWorkspace& ws;
+    const SaliencyOptions& options;
+    const GaborBank* bank;              // orientation filters, or
+    const SteerableGabor* steerable;    // their steerable basis
+    GaborParams params;
+};
+
+/**
+* Lays out the pyramids and orientation buffers the tasks of
+* conspicuity_pyramids write into, and computes everything the tasks only
+* read (the Gabor banks and steering weights), before any task runs.
+*
+* @param workspace pipeline buffers
+* @param options   pipeline options
+* @param tasks     tasks of the DECIMATE stage
+*/
+static void prepare_conspicuity(SaliencyWorkspace& workspace, const SaliencyOptions& options,
+                                const ConspicuityTasks& tasks)
+{
+    int numOrient = options.numOrientations;
+    int scale = options.startScale;
+
+    for (int k = 0; k < 5; ++k)
+    {
+        if (channel_needs_pyramid(k, options))
+        {
+            workspace.pyramids[k].begin(workspace.channels[k], numPyrLevels, scale, cL,
+                                        channel_fixed_scale(k, options), options.resampling, ROW_BANDS);
+        }
+    }
+
+    GaborParams params = itti_gabor_params(numOrient);
+    if (options.orientationOnPyramid)
+    {
+        // orientation pyramids with levels cL and up only, the filters write
+        // straight into the pyramid levels
+        Size size = workspace.pyramids[4].level_size(cL);
+        for (int k = 0; k < numOrient; ++k)
+        {
+            workspace.orPyr[k].allocate(size, numPyrLevels, CV_32F, cL, cL);
+            if (options.steerable)
+            {
+                continue;
+            }
+            GaborParams single = params;
+            single.thetas.assign(1, params.thetas[k]);
+            cached_gabor_bank(single);
+        }
+        if (options.steerable)
+        {
+            cached_steerable_gabor(options.steerableBasis).prepare(params.thetas);
+        }
+        return;
+    }
+
+    Size size = workspace.channels[4].size();
+    for (int k = 0; k < numOrient; ++k)
+    {
+        workspace.orientations[k].create(size, CV_32F);
+    }
+    workspace.bandScratch.resize(tasks.num_gabor_tasks());
+    if (options.steerable)
+    {
+        SteerableGabor& steerable = cached_steerable_gabor(options.steerableBasis);
+        steerable.prepare(params.thetas);
+        workspace.orBasis.resize(steerable.basis_size());
+        for (int j = 0; j < steerable.basis_size(); ++j)
+        {
+            workspace.orBasis[j].create(size, CV_32F);
+        }
+    }
+
+    if (tasks.orientation_pyramids())
+    {
+        for (int k = 0; k < numOrient; ++k)
+        {
+            workspace.orPyr[k].begin(workspace.orientations[k], numPyrLevels, scale, 0, 0,
+                                     options.resampling, ROW_BANDS);
+        }
+    }
+}
+
+/**
+* Computes the normalized conspicuity pyramids of all channels: everything
+* between split_rgbyi and the integration, as tasks on the OpenCV thread pool
+* (see ConspicuityTasks). Every task computes exactly its part of the serial
+* result, so the result is identical for any number of threads
+* (cv::setNumThreads).
+*
+* Reads workspace.channels (red, green, blue, yellow and intensity at level
+* options.startScale) and writes intens_cm, oppRG_cm, oppBY_cm (numMaps of
+* SaliencyScales each), orientations (options.numOrientations maps) and or_cm
+* (numMaps per orientation).
+*
+* @param workspace    pipeline buffers
+* @param options      pipeline options
+* @param stageSeconds output, the time of the DECIMATE (with the
+*                     preparation), PYRAMIDS and CONSPICUITY stages, NULL if
+*                     not needed
+*/
+void conspicuity_pyramids(SaliencyWorkspace& workspace, const SaliencyOptions& options, double* stageSeconds)
+{
+    CV_Assert(options.startScale >= 0 && options.startScale <= cL);
+    CV_Assert(options.numOrientations > 0 && options.numOrientations % 4 == 0);
+    workspace.fit(options);
+
+    const ConspicuityTasks::Stage stages[3] =
+        {ConspicuityTasks::DECIMATE, ConspicuityTasks::PYRAMIDS, ConspicuityTasks::CONSPICUITY};
+    for (int i = 0; i < 3; ++i)
+    {
+        double t = (double)getTickCount();
+        ConspicuityTasks tasks(stages[i], workspace, options);
+        if (i == 0)
+        {
+            prepare_conspicuity(workspace, options, tasks);
+        }
+        parallel_for_(Range(0, tasks.num_tasks()), tasks, tasks.num_tasks());
+        if (stageSeconds)
+        {
+            stageSeconds[i] = ((double)getTickCount() - t) / getTickFrequency();
+        }
+    }
+}
+
+/**
+* Normalizes the center-surround maps of one orientation and adds their
+* integration to the running orientation conspicuity map.
+*
+* @param or_cm  numMaps center-surround maps, normalized in place
+* @param ori_CM running orientation conspicuity map, overwritten by the first
+* @param first  true for the first orientation
+*/
+static void fold_orientation_maps(Mat* or_cm, Mat& ori_CM, bool first)
+{
+    normalize_pyramid(or_cm, numCSMaps);
+    if (first)
+    {
+        integrate_single_pyramid(or_cm, ori_CM, numCSMaps);
+        normalize(ori_CM);
+        return;
+    }
+
+    Mat fmap;
+    integrate_single_pyramid(or_cm, fmap, numCSMaps);
+    normalize(fmap);
+    add(ori_CM, fmap, ori_CM);
+}
+
+/**
+* Adds the normalized conspicuity pyramid of one orientation map to the
+* orientation conspicuity map (the streaming form of integrate_orient_pyamids).
+*
+* @param orPyr      pyramid of the orientation map
+* @param ori_CM     running orientation conspicuity map, overwritten by the
+*                   first
+* @param first      true for the first orientation
+* @param resampling resampling tier (see Resampling)
+*/
+static void fold_orientation(Pyramid& orPyr, Mat& ori_CM, bool first, Resampling resampling)
+{
+    Mat or_cm[numCSMaps];
+    across_scale_diff(orPyr, or_cm, resampling);
+    fold_orientation_maps(or_cm, ori_CM, first);
+}
+
+/**
+* fold_orientation for the box engine, from the orientation map itself.
+*
+* @param orientation orientation map (CV_32F)
+* @param inputLayer  layer of the map (0 for full resolution)
+* @param ori_CM      running orientation conspicuity map, overwritten by the
+*                    first
+* @param first       true for the first orientation
+*/
+static void fold_box_orientation(Mat& orientation, int inputLayer, Mat& ori_CM, bool first)
+{
+    Mat or_cm[numCSMaps];
+    box_across_scale_diff(orientation, inputLayer, or_cm);
+    fold_orientation_maps(or_cm, ori_CM, first);
+}
+
+/**
+* Low peak memory form of conspicuity_pyramids followed by the integration:
+* the channels are processed one after the other and each one's pyramids,
+* conspicuity maps and orientation map are folded into the running
+* conspicuity maps and freed before the next channel starts. At any time
+* only one channel (two for the opponencies) has pyramids alive, against all
+* of them plus every orientation map in the default mode. Those buffers are
+* allocated on every call, only the outputs are reused. Runs on the calling
+* thread. The sums are accumulated per channel instead of interleaved, so the
+* maps differ from the default mode by float round-off only.
+*
+* @param channels     red, green, blue, yellow and intensity (CV_32F) at level
+*                     options.startScale
+* @param intens_CM    output, integrated intensity conspicuity map
+* @param opp_CM       output, integrated opponency conspicuity map
+* @param ori_CM       output, integrated orientation conspicuity map
+* @param orientations output, the 0, 45, 90 and 135 degree orientation maps
+*                     (as returned by orientation_features), NULL if not
+*                     needed
+* @param options      pipeline options
+*/
+void streaming_conspicuity_maps(Mat* channels, Mat& intens_CM, Mat& opp_CM, Mat& ori_CM,
+                                Mat* orientations, const SaliencyOptions& options)
+{
+    CV_Assert(options.startScale >= 0 && options.startScale <= cL);
+    CV_Assert(options.numOrientations > 0 && options.numOrientations % 4 == 0);
+
+    int numOrient = options.numOrientations;
+    int scale = options.startScale;
+
+    // intensity, and orientations filtered on the intensity pyramid levels
+    {
+        Pyramid intensPyr;
+        if (channel_needs_pyramid(4, options))
+        {
+            construct_pyramid(channels[4], intensPyr, numPyrLevels, scale, channel_fixed_scale(4, options),
+                              options.resampling);
+        }
+
+        Mat cm[numCSMaps];
+        if (options.boxCenterSurround)
+        {
+            box_across_scale_diff(channels[4], scale, cm);
+        } else {
+            across_scale_diff(intensPyr, cm, options.resampling);
+        }
+        normalize_pyramid(cm, numCSMaps);
+        integrate_single_pyramid(cm, intens_CM, numCSMaps);
+
+        for (int k = 0; options.orientationOnPyramid && k < numOrient; ++k)
+        {
+            Pyramid orPyr;
+            orPyr.allocate(intensPyr.level_size(cL), numPyrLevels, CV_32F, cL, cL);
+            for (int level = cL; level < numPyrLevels; ++level)
+            {
+                Mat levelMap = orPyr[level];
+                compute_orientation(intensPyr[level], k, levelMap, options);
+            }
+            fold_orientation(orPyr, ori_CM, k == 0, options.resampling);
+
+            if (orientations && k % (numOrient/4) == 0)
+            {
+                orientations[k / (numOrient/4)] = orPyr[cL].clone();
+            }
+        }
+    }
+
+    // orientations filtered at full resolution
+    for (int k = 0; !options.orientationOnPyramid && k < numOrient; ++k)
+    {
+        Mat orientation;
+        compute_orientation(channels[4], k, orientation, options);
+
+        if (options.boxCenterSurround)
+        {
+            fold_box_orientation(orientation, scale, ori_CM, k == 0);
+        } else {
+            Pyramid orPyr;
+            construct_pyramid(orientation, orPyr, numPyrLevels, scale, 0, options.resampling);
+            fold_orientation(orPyr, ori_CM, k == 0, options.resampling);
+        }
+
+        if (orientations && k % (numOrient/4) == 0)
+        {
+            orientations[k / (numOrient/4)] = orientation;
+        }
+    }
+
+    // red-green, then blue-yellow opponency
+    for (int pair = 0; pair < 2; ++pair)
+    {
+        Mat cm[numCSMaps], sum;
+        if (options.boxCenterSurround)
+        {
+            box_across_scale_opponency_diff(channels[2*pair], channels[2*pair + 1], scale, cm);
+        } else {
+            Pyramid pyr1, pyr2;
+            construct_pyramid(channels[2*pair], pyr1, numPyrLevels, scale,
+                              channel_fixed_scale(2*pair, options), options.resampling);
+            construct_pyramid(channels[2*pair + 1], pyr2, numPyrLevels, scale,
+                              channel_fixed_scale(2*pair + 1, options), options.resampling);
+            across_scale_opponency_diff(pyr1, pyr2, cm, options.resampling);
+        }
+        normalize_pyramid(cm, numCSMaps);
+
+        if (pair == 0)
+        {
+            integrate_single_pyramid(cm, opp_CM, numCSMaps);
+        } else {
+            integrate_single_pyramid(cm, sum, numCSMaps);
+            add(opp_CM, sum, opp_CM);
+        }
+    }
+}
+
+/**
+* Reads pipeline options from command line arguments, starting at argv[first]:
+* 	--orientations N   number of orientations (multiple of 4)
+* 	--steerable [B]    steerable orientation mode with B basis kernels
+* 	--orientation-pyramid
+* 	                   filter the intensity pyramid levels for orientation
+* 	--start-scale L    start the pipeline at pyramid level L (0-2)
+* 	--threads N        number of threads (see apply_thread_count)
+* 	--low-memory       process one channel at a time (streaming_conspicuity_maps)
+* 	--fixed-point      16 bit fixed point channel pyramids
+* 	--resampling T     resampling tier: exact, fast or fastest
+* 	--box-dog          box mean center-surround (BoxCenterSurround)
+* 	--coarse-maps      base maps at the size of the conspicuity maps
+* 	--backend B        saliency backend: itti or spectral
+*
+* @param  argc  number of arguments
+* @param  argv  arguments
+* @param  first index of the first option
+* @return       the options, defaults for anything not given
+*/
+SaliencyOptions parse_saliency_options(int argc, char** argv, int first)
+{
+    SaliencyOptions options;
+
+    for (int i = first; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--orientations" && i + 1 < argc)
+        {
+            options.numOrientations = atoi(argv[++i]);
+        } else if (arg == "--steerable")
+        {
+            options.steerable = true;
+            if (i + 1 < argc && isdigit(argv[i+1][0]))
+            {
+                options.steerableBasis = atoi(argv[++i]);
+            }
+        } else if (arg == "--orientation-pyramid")
+        {
+            options.orientationOnPyramid = true;
+        } else if (arg == "--start-scale" && i + 1 < argc)
+        {
+            options.startScale = atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc)
+        {
+            options.numThreads = atoi(argv[++i]);
+        } else if (arg == "--low-memory")
+        {
+            options.lowMemory = true;
+        } else if (arg == "--fixed-point")
+        {
+            options.fixedPoint = true;
+        } else if (arg == "--box-dog")
+        {
+            options.boxCenterSurround = true;
+        } else if (arg == "--coarse-maps")
+        {
+            options.coarseMaps = true;
+        } else if (arg == "--backend" && i + 1 < argc)
+        {
+            string backend = argv[++i];
+            if (backend == "spectral")
+            {
+                options.backend = BACKEND_SPECTRAL;
+            } else if (backend != "itti")
+            {
+                cout << "Ignoring unknown backend " << backend << endl;
+            }
+        } else if (arg == "--resampling" && i + 1 < argc)
+        {
+            string tier = argv[++i];
+            if (tier == "fast")
+            {
+                options.resampling = RESAMPLE_FAST;
+            } else if (tier == "fastest")
+            {
+                options.resampling = RESAMPLE_FASTEST;
+            } else if (tier != "exact")
+            {
+                cout << "Ignoring unknown resampling tier " << tier << endl;
+            }
+        } else {
+            cout << "Ignoring unknown option " << arg << endl;
+        }
+    }
+    return options;
+}
+
+/**
+* Sets the size of the OpenCV thread pool the pipeline runs on, if the
+* options ask for one (options.numThreads > 0).
+*
+* @param options pipeline options
+*/
+void apply_thread_count(const SaliencyOptions& options)
+{
+    if (options.numThreads > 0)
+    {
+        setNumThreads(options.numThreads);
+    }
 }
@@ -5,12 +5,182 @@
 #include <typeinfo>
 #include <iostream>
 #include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <string>
+#include <vector>
+#include "pyramid.h"
+#include "centerSurround.h"
+#include "boxCenterSurround.h"
+#include "scales.h"
+
+#ifndef SALIENCY_H
+#define SALIENCY_H
+
+/**
+* Saliency backends behind computeBaseMaps and the pipelines built on it:
+* 	BACKEND_ITTI      center-surround pyramids (Itti et al)
+* 	BACKEND_SPECTRAL  spectral residual of each channel on a SPECTRAL_WIDTH
+* 	                  wide image (see spectral.h), a rough map in a fraction
+* 	                  of the time
+*/
+enum SaliencyBackend { BACKEND_ITTI, BACKEND_SPECTRAL };
+
+/**
+* Options of the saliency pipeline.
+* 	numOrientations   orientations integrated into the orientation conspicuity
+* 	                  map, evenly spaced over 180 degrees (multiple of 4 so
+* 	                  0, 45, 90 and 135 degrees are always included)
+* 	steerable         synthesize the orientations from a steerable basis
+* 	                  instead of filtering with one Gabor kernel each
+* 	steerableBasis    number of basis kernels in steerable mode
+* 	orientationOnPyramid
+* 	                  filter the levels of the intensity pyramid instead of
+* 	                  building pyramids from full resolution orientation maps
+* 	startScale        pyramid level the pipeline starts at: the BGR input is
+* 	                  downsampled to this level before any other work (0 for
+* 	                  full resolution, at most cL of SaliencyScales, the finest
+* 	                  center scale)
+* 	numThreads        threads of the OpenCV pool used for the channels of one
+* 	                  image (0 keeps the OpenCV default), see apply_thread_count
+* 	lowMemory         process the channels one at a time to keep the peak
+* 	                  memory low (see streaming_conspicuity_maps), at the
+* 	                  cost of allocating their buffers on every frame
+* 	fixedPoint        store the channel pyramids from level cL up, and the
+* 	                  center-surround maps computed from them, as 16 bit
+* 	                  fixed point (CV_16S; colors scaled by 2^14-1, intensity
+* 	                  by 2^7) instead of fp32, halving their memory and
+* 	                  memory traffic. The conspicuity maps are converted back
+* 	                  to fp32 for the normalization. Every rounding (the
+* 	                  conversion, each pyrDown and pyrUp) adds at most half
+* 	                  a step and the filters do not amplify errors, so a
+* 	                  center-surround map is within 7 steps of the fp32
+* 	                  pipeline (14 for the opponencies, which combine two
+* 	                  pyramids): 9e-4 for the colors in [0, 1] and 0.06
+* 	                  gray levels for the intensity. The colors must stay
+* 	                  in [0, 1] so their opponency differences fit in 16
+* 	                  bits (asserted, see CenterSurroundEngine). The
+* 	                  channels, the orientation maps and the intensity
+* 	                  pyramid in orientationOnPyramid mode stay fp32. "benchmark
+* 	                  precision" reports the resulting difference of the
+* 	                  final saliency map.
+* 	resampling        pyramid decimation and center-surround upsampling (see
+* 	                  Resampling); the fast tiers trade accuracy for latency,
+* 	                  "benchmark resampling" reports both against exact
+* 	boxCenterSurround center-surround differences from box means of one
+* 	                  summed-area table per channel (BoxCenterSurround)
+* 	                  instead of pyramids. Only the intensity pyramid is
+* 	                  built, in orientationOnPyramid mode, whose orientation
+* 	                  maps stay on the pyramid engine; fixedPoint and
+* 	                  resampling do not apply to the box maps.
+* 	coarseMaps        keep the base maps (see computeBaseMaps) at the size of
+* 	                  the conspicuity maps, downsampling the channel and
+* 	                  orientation maps to it, instead of upsampling the
+* 	                  conspicuity maps to the working image. Proposals are
+* 	                  scored on the maps at their own scale either way (see
+* 	                  mapSaliencyScore). Only the base maps stay small: the
+* 	                  channels, the orientation maps and the pyramids built
+* 	                  from them are still computed at the working size.
+* 	                  The proposal paths (topProposals, rankProposals, ...)
+* 	                  always use coarse base maps.
+* 	backend           saliency backend (see SaliencyBackend); every other
+* 	                  option applies to BACKEND_ITTI only
+*/
+struct SaliencyOptions
+{
+    int numOrientations;
+    bool steerable;
+    int steerableBasis;
+    bool orientationOnPyramid;
+    int startScale;
+    int numThreads;
+    bool lowMemory;
+    bool fixedPoint;
+    Resampling resampling;
+    bool boxCenterSurround;
+    bool coarseMaps;
+    SaliencyBackend backend;
+
+    SaliencyOptions();
+};
+
+/**
+* Buffers of the saliency pipeline for one frame size. Passing the same
+* workspace to every call (e.g. for the frames of a camera stream) reuses all
+* of them, so after the first frame of a given size and set of options the
+* pipeline allocates nothing of its own. The exception is lowMemory mode,
+* whose channel pyramids and center-surround maps are allocated and freed
+* per channel on every frame (keeping them would hold all of them at once,
+* the peak the mode avoids); only the integrated maps are reused. Maps
+* returned by a pipeline that uses a workspace point into it and are
+* overwritten by the next call.
+*/
+struct SaliencyWorkspace
+{
+    SaliencyWorkspace();
+    SaliencyWorkspace(cv::Size, const SaliencyOptions&);
+
+    void fit(const SaliencyOptions&);
+    void reserve(cv::Size, const SaliencyOptions&);
+
+    cv::Mat downsampled[SaliencyScales::cL];  // input at levels 1 to cL (startScale)
+    cv::Mat channels[5];                // red, green, blue, yellow, intensity
+    Pyramid pyramids[5];                // pyramids of the channels
+    CenterSurround engines[3];          // intensity, red-green, blue-yellow
+    BoxCenterSurround boxEngines[3];    // the same, in boxCenterSurround mode
+    cv::Mat intens_cm[SaliencyScales::numMaps];
+    cv::Mat oppRG_cm[SaliencyScales::numMaps];
+    cv::Mat oppBY_cm[SaliencyScales::numMaps];
+
+    std::vector<cv::Mat> orientations;  // one map per orientation
+    std::vector<cv::Mat> or_cm;         // numMaps conspicuity maps per orientation
+    std::vector<Pyramid> orPyr;
+    std::vector<CenterSurround> orEngines;
+    std::vector<BoxCenterSurround> orBoxEngines;
+    std::vector<cv::Mat> orLevelMaps;   // orientation responses of one level
+    std::vector<cv::Mat> orBasis;       // steerable basis responses
+    std::vector<cv::Mat> bandScratch;   // one per orientation filtering task
+
+    cv::Mat intens_CM, opp_CM, ori_CM;  // integrated conspicuity maps
+    cv::Mat orScratch;                  // integrated maps of one orientation
+    cv::Mat resized[11];                // conspicuity and orientation maps
+                                        // at the size of the working image,
+                                        // or the channels and orientation
+                                        // maps downsampled (coarseMaps);
+                                        // partial sums of generateSaliency*
+    cv::Mat global_CM;
+
+    cv::Mat spectralInput;              // input at the spectral backend size
+    cv::Mat spectralBuffers[4];         // see spectral_residual
+    cv::Mat opponency;                  // difference of two channels
+};
 
 
 void split_rgbyi(cv::Mat&, cv::Mat*);
-void construct_pyramid(cv::Mat&, cv::Mat*, int);
-void across_scale_diff(cv::Mat*, cv::Mat*);
-void across_scale_opponency_diff(cv::Mat*, cv::Mat*, cv::Mat*);
-void integrate_single_pyramid(cv::Mat*, cv::Mat, int);
-void integrate_color_pyamids(cv::Mat*, cv::Mat*, cv::Mat, int);
-void integrate_orient_pyamids(cv::Mat*, cv::Mat*, cv::Mat*, cv::Mat*, cv::Mat, int);
+void split_rgbyi_reference(cv::Mat&, cv::Mat*);
+void construct_pyramid(cv::Mat&, Pyramid&, int, int = 0, double = 0, Resampling = RESAMPLE_EXACT);
+void across_scale_diff(Pyramid&, cv::Mat*, Resampling = RESAMPLE_EXACT);
+void across_scale_opponency_diff(Pyramid&, Pyramid&, cv::Mat*, Resampling = RESAMPLE_EXACT);
+void box_across_scale_diff(cv::Mat&, int, cv::Mat*);
+void box_across_scale_opponency_diff(cv::Mat&, cv::Mat&, int, cv::Mat*);
+void accumulate_maps(const cv::Mat* const*, int, cv::Mat&);
+void weighted_sum_maps(const cv::Mat* const*, const float*, int, cv::Mat&);
+void max_weighted_maps(const cv::Mat* const*, const float*, int, cv::Mat&);
+void weighted_sum_maps_batch(const cv::Mat* const*, const float*, int, int, cv::Mat*);
+void mean_maps(const cv::Mat* const*, int, double*);
+void integrate_single_pyramid(cv::Mat*, cv::Mat&, int);
+void integrate_color_pyamids(cv::Mat*, cv::Mat*, cv::Mat&, int);
+void integrate_orient_pyamids(cv::Mat*, int, cv::Mat&, int, cv::Mat* = NULL);
+void compute_orientations(cv::Mat&, cv::Mat*, const SaliencyOptions&);
+void compute_orientation(cv::Mat&, int, cv::Mat&, const SaliencyOptions&);
+void orientation_conspicuity(cv::Mat*, cv::Mat*, int, int = 0, Pyramid* = NULL,
+                             CenterSurround* = NULL, Resampling = RESAMPLE_EXACT);
+void downsample_input(cv::Mat&, cv::Mat&, int, cv::Mat* = NULL, Resampling = RESAMPLE_EXACT);
+void conspicuity_pyramids(SaliencyWorkspace&, const SaliencyOptions&, double* = NULL);
+void orientation_features(SaliencyWorkspace&, const SaliencyOptions&);
+void streaming_conspicuity_maps(cv::Mat*, cv::Mat&, cv::Mat&, cv::Mat&, cv::Mat*,
+                                const SaliencyOptions&);
+SaliencyOptions parse_saliency_options(int, char**, int);
+void apply_thread_count(const SaliencyOptions&);
+
+#endif
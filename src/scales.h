@@ -0,0 +1,57 @@
+/**
+* Scale configuration of the saliency pipeline as compile-time constants.
+*
+* 	numLevels   levels of every Gaussian pyramid (level 0 is the input)
+* 	cL, cU      center scales, inclusive
+* 	sL, sU      surround offsets, inclusive (surround level = c + s)
+* 	numMaps     center-surround maps per feature, stored at scale cU
+*
+* Code that takes a configuration as a template parameter (e.g.
+* CenterSurroundEngine) gets its scale loops unrolled and its per-scale
+* branches resolved by the compiler. SaliencyScales is the configuration of
+* the pipeline: Itti's scales by default, the 7 level variant when the build
+* defines ATTEND_SEVEN_LEVELS.
+*/
+
+#ifndef SCALES_H
+#define SCALES_H
+
+template <int Levels, int CenterLow, int CenterHigh, int SurroundLow, int SurroundHigh>
+struct ScaleConfig
+{
+    enum
+    {
+        numLevels = Levels,
+        cL = CenterLow,
+        cU = CenterHigh,
+        sL = SurroundLow,
+        sU = SurroundHigh,
+        numSurrounds = SurroundHigh - SurroundLow + 1,
+        numMaps = (CenterHigh - CenterLow + 1) * numSurrounds
+    };
+
+    // the coarsest surround must be a level of the pyramid
+    typedef char scales_fit_pyramid[(CenterLow <= CenterHigh && SurroundLow <= SurroundHigh &&
+                                      CenterHigh + SurroundHigh < Levels) ? 1 : -1];
+};
+
+// one pyramid level as a type, to recurse over the scales at compile time
+template <int Level>
+struct ScaleLevel
+{
+};
+
+// as defined in itti's paper
+typedef ScaleConfig<9, 2, 4, 3, 4> IttiScales;
+
+// 7 levels (e.g. 320x240 sensors, where level 8 would be a single pixel);
+// the conspicuity maps are at level 3, the size Itti's are at for 640x480
+typedef ScaleConfig<7, 1, 3, 2, 3> SevenLevelScales;
+
+#ifdef ATTEND_SEVEN_LEVELS
+typedef SevenLevelScales SaliencyScales;
+#else
+typedef IttiScales SaliencyScales;
+#endif
+
+#endif
@@ -0,0 +1,71 @@
+#include "spectral.h"
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+// added to the amplitude before the log, for frequencies with none
+static const float AMPLITUDE_EPSILON = 1e-6f;
+
+/**
+* Size of the working image of the spectral backend for an input: width
+* SPECTRAL_WIDTH, the height that keeps the aspect ratio rounded up to a size
+* the DFT is fast for.
+*
+* @param  input size of the input image
+* @return       working size
+*/
+Size spectral_size(Size input)
+{
+    int height = cvRound((double) input.height * SPECTRAL_WIDTH / input.width);
+    return Size(SPECTRAL_WIDTH, getOptimalDFTSize(std::max(height, 1)));
+}
+
+/**
+* Spectral residual saliency map of a single channel.
+*
+* With F the spectrum of the channel, A = log|F| its log amplitude and
+* R = A - mean3x3(A) the residual, the map is |IDFT(exp(R) F / |F|)|^2,
+* smoothed. exp(R) / |F| = exp(-mean3x3(A)), so the spectrum is only
+* multiplied by one real weight per frequency.
+*
+* @param channel  CV_32F channel (see spectral_size for a good size)
+* @param saliency output map, CV_32F of the size of the channel
+* @param buffers  4 buffers to reuse (spectrum, its real and imaginary planes
+*                 and the weights), NULL to allocate
+*/
+void spectral_residual(const Mat& channel, Mat& saliency, Mat* buffers)
+{
+    Mat local[4];
+    Mat* b = buffers ? buffers : local;
+    Mat& spectrum = b[0];
+    Mat planes[2] = {b[1], b[2]};
+    Mat& weights = b[3];
+
+    dft(channel, spectrum, DFT_COMPLEX_OUTPUT);
+    split(spectrum, planes);
+
+    magnitude(planes[0], planes[1], weights);
+    weights += Scalar::all(AMPLITUDE_EPSILON);
+    log(weights, weights);
+    blur(weights, weights, Size(3, 3));
+    weights *= -1;
+    exp(weights, weights);
+
+    multiply(planes[0], weights, planes[0]);
+    multiply(planes[1], weights, planes[1]);
+    merge(planes, 2, spectrum);
+
+    idft(spectrum, spectrum, DFT_SCALE);
+    split(spectrum, planes);
+    magnitude(planes[0], planes[1], saliency);
+    multiply(saliency, saliency, saliency);
+    GaussianBlur(saliency, saliency, Size(5, 5), 8);
+
+    // keep the plane buffers for the next call
+    if (buffers)
+    {
+        b[1] = planes[0];
+        b[2] = planes[1];
+    }
+}
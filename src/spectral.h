@@ -0,0 +1,24 @@
+/**
+* Spectral residual saliency (Hou and Zhang, 2007), the frequency domain
+* backend of the pipeline (SaliencyOptions::backend).
+*
+* The log amplitude spectrum of an image, minus its local average, is the
+* part of the spectrum that stands out from the smooth 1/f falloff of natural
+* images; transformed back with the original phase it leaves the unexpected
+* regions of the image. Only meaningful (and only cheap) on small images:
+* the backend works on the input resized to SPECTRAL_WIDTH columns.
+*/
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#ifndef SPECTRAL_H
+#define SPECTRAL_H
+
+// width of the working image of the spectral backend
+const int SPECTRAL_WIDTH = 64;
+
+cv::Size spectral_size(cv::Size);
+void spectral_residual(const cv::Mat&, cv::Mat&, cv::Mat* = NULL);
+
+#endif
@@ -5,11 +5,14 @@
 #include <typeinfo>
 #include <iostream>
 #include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
 
 using namespace std;
 using namespace cv;
 
-void my_imshow(string name, Mat matrix, int x, int y)
+inline void my_imshow(string name, Mat matrix, int x, int y)
 {
     namedWindow(name, WINDOW_AUTOSIZE);
     moveWindow(name, x, y);
@@ -20,7 +23,7 @@ void my_imshow(string name, Mat matrix, int x, int y)
 
 }
 
-void debug_show_imgPyramid(Mat* imgPyramid, string pyramidInfo)
+inline void debug_show_imgPyramid(Mat* imgPyramid, string pyramidInfo)
 {
 
     for (int i = 0; i < 6; i++) {
@@ -36,3 +39,21 @@ void debug_show_imgPyramid(Mat* imgPyramid, string pyramidInfo)
     waitKey(100000);
     destroyAllWindows();
 }
+
+/**
+* Peak resident memory of the process so far (VmHWM in /proc/self/status),
+* in kB; -1 where it is not available.
+*/
+inline long peak_memory_kb()
+{
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return atol(line.c_str() + 6);
+        }
+    }
+    return -1;
+}